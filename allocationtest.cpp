@@ -0,0 +1,238 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:               allocationtest.cpp
+// Description:        Test: steps of a world with a stable population don't allocate
+// Author:             Alexey Orlov (https://github.com/m110h)
+// Last modification:  18/08/2020
+// Licence:            MIT licence
+/////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <string>
+#include <atomic>
+#include <algorithm>
+#include <new>
+#include <cstdlib>
+#include <cstdint>
+
+#include "entities.h"
+#include "properties.h"
+#include "poolallocator.h"
+
+// Pools and buffers of a step grow to the largest world they have seen, so a
+// step allocates only when the world becomes larger than it has ever been.
+// The test warms a world up until its population is stable and then counts
+// allocations of a long continuation of the same run, which visits states
+// the warm-up never had: none of its steps may allocate, and resident pages
+// of the pool of blocks of cells may not exceed the most of the warm-up.
+//
+// All replaceable forms of the global operator new are counted. Pages of the
+// pool are mapped from the system on Linux and come from the aligned operator
+// new elsewhere, so they are checked by the quantity of resident pages and
+// not counted as allocations. Lineage trees keep extinct ancestors up to
+// their budget, a small one lets them reach their size during the warm-up.
+
+static std::atomic<bool> countingAllocations {false};
+static std::atomic<std::size_t> allocationsCounter {0};
+
+static void* Allocate(std::size_t size)
+{
+    if (countingAllocations.load(std::memory_order_relaxed))
+        allocationsCounter.fetch_add(1, std::memory_order_relaxed);
+
+    return std::malloc(size > 0 ? size : 1);
+}
+
+static void* AllocateAligned(std::size_t size, std::align_val_t alignment)
+{
+    const std::size_t align = static_cast<std::size_t>(alignment);
+
+    if (countingAllocations.load(std::memory_order_relaxed) && align != ProtoPuddle::PoolAllocator::pageSize)
+        allocationsCounter.fetch_add(1, std::memory_order_relaxed);
+
+    // the address of the block of malloc is kept just before the aligned one
+    void* memory = std::malloc(size + align + sizeof(void*));
+
+    if (memory == nullptr)
+        return nullptr;
+
+    const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(memory) + sizeof(void*);
+    void** aligned = reinterpret_cast<void**>((address + align - 1) & ~(align - 1));
+
+    aligned[-1] = memory;
+
+    return aligned;
+}
+
+static void FreeAligned(void* memory)
+{
+    if (memory != nullptr)
+        std::free(static_cast<void**>(memory)[-1]);
+}
+
+void* operator new(std::size_t size)
+{
+    if (void* memory = Allocate(size))
+        return memory;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    if (void* memory = Allocate(size))
+        return memory;
+
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return Allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return Allocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    if (void* memory = AllocateAligned(size, alignment))
+        return memory;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    if (void* memory = AllocateAligned(size, alignment))
+        return memory;
+
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return AllocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return AllocateAligned(size, alignment);
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { FreeAligned(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { FreeAligned(memory); }
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept { FreeAligned(memory); }
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept { FreeAligned(memory); }
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept { FreeAligned(memory); }
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept { FreeAligned(memory); }
+
+struct Scenario
+{
+    const char* name;
+    int order;
+    int compaction;
+    bool lineageCells;
+    int threads;
+};
+
+static const std::size_t lineageBudget {128};
+
+static std::size_t GetResidentPages(ProtoPuddle::World& world)
+{
+    return std::get<0>(world.GetMemoryPages()) / ProtoPuddle::PoolAllocator::pageSize;
+}
+
+// returns allocations of steps of the continuation, and the most of resident
+// pages of the warm-up and of the continuation
+static std::size_t Continue(ProtoPuddle::World& world, long long warmup, long long steps, std::size_t& warmupPages, std::size_t& pages)
+{
+    world.New();
+
+    warmupPages = GetResidentPages(world);
+
+    for (long long i=0; i<warmup; i++)
+    {
+        world.Step();
+        warmupPages = std::max(warmupPages, GetResidentPages(world));
+    }
+
+    pages = 0;
+
+    for (long long i=0; i<steps; i++)
+    {
+        countingAllocations = true;
+        world.Step();
+        countingAllocations = false;
+
+        pages = std::max(pages, GetResidentPages(world));
+    }
+
+    return allocationsCounter;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: protopuddle-alloc-test config.json [warmup] [steps] [seed]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const std::string configFile = argv[1];
+    const long long warmup = (argc > 2) ? std::atoll(argv[2]) : 2500;
+    const long long steps = (argc > 3) ? std::atoll(argv[3]) : 2500;
+    const std::uint64_t seed = (argc > 4) ? std::strtoull(argv[4], nullptr, 10) : 1;
+
+    const Scenario scenarios[] {
+        {"random", ProtoPuddle::Scheduler::ORDER_RANDOM, 0, false, 1},
+        {"sweep, compaction", ProtoPuddle::Scheduler::ORDER_SWEEP, 50, false, 1},
+        {"checkerboard, cell lineage", ProtoPuddle::Scheduler::ORDER_CHECKERBOARD, 0, true, 1},
+        {"synchronous, 4 threads", ProtoPuddle::Scheduler::ORDER_SYNCHRONOUS, 0, false, 4}
+    };
+
+    bool failed = false;
+
+    for (const Scenario& scenario: scenarios)
+    {
+        ProtoPuddle::GlobalProperties properties;
+        ProtoPuddle::World world(&properties);
+
+        auto [flag, error] = world.OpenFromFile(configFile);
+
+        if (!flag)
+        {
+            std::cerr << configFile << ": " << error << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        properties.SetValue("updateOrder", scenario.order);
+        properties.SetValue("compactionInterval", scenario.compaction);
+
+        world.SetLineageOptions("", scenario.lineageCells, lineageBudget);
+        world.SetThreads(scenario.threads);
+        world.SetSeed(seed);
+
+        allocationsCounter = 0;
+
+        std::size_t warmupPages = 0;
+        std::size_t pages = 0;
+        const std::size_t allocations = Continue(world, warmup, steps, warmupPages, pages);
+
+        std::cout << scenario.name << ": " << allocations << " allocations and at most "
+                  << pages << " resident pages (" << warmupPages << " in the warm-up) in "
+                  << steps << " steps after " << warmup << std::endl;
+
+        if (allocations > 0 || pages > warmupPages)
+            failed = true;
+    }
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,356 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:               cellstore.h
+// Description:        Structure-of-arrays storage of cells
+// Author:             Alexey Orlov (https://github.com/m110h)
+// Last modification:  18/08/2020
+// Licence:            MIT licence
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _CELL_STORE_H_
+#define _CELL_STORE_H_
+
+#include <vector>
+#include <new>
+#include <limits>
+#include <cstdint>
+#include <cstddef>
+
+#include "types.h"
+#include "thirdparty/allocator/allocator.h"
+
+namespace ProtoPuddle
+{
+
+// Attributes of blockSize cells, every attribute is an array of its own, so a
+// loop over one attribute reads contiguous memory.
+struct CellBlock
+{
+    static const int shift {8};
+    static const int size {1 << shift};
+    static const int mask {size - 1};
+
+    Point position[size];
+
+    int energy[size];
+    int age[size];
+    int lifeTime[size];
+    int divEnergy[size];
+    int damage[size];
+    int mutationProbability[size];
+
+    int id[size];
+    std::uint32_t slot[size];
+
+    int childrenCounter[size];
+    int killsCounter[size];
+    int eatenPlantsCounter[size];
+    int eatenMeatCounter[size];
+
+    std::uint16_t geneId[size];
+    std::uint32_t species[size];
+    std::uint32_t lineage[size];
+
+    std::uint8_t direction[size];
+    std::uint8_t lastBehavior[size];
+
+    bool attacked[size];
+    bool queued[size];
+};
+
+// Cells are dense: live cells have indices [0, quantity). A removed cell is
+// replaced by the last one, so the owner must fix references to the moved
+// cell (see Copy, PopBack and Permute). Blocks are taken from the allocator
+// of the world; a block is returned when two blocks at the end became empty.
+class CellStore
+{
+public:
+    // the last situation handled by a cell, it is shown by the GUI
+    enum
+    {
+        BEHAVIOR_NONE = 0,
+        BEHAVIOR_ATTACKED,
+        BEHAVIOR_DIVISION,
+        BEHAVIOR_WALL,
+        BEHAVIOR_EMPTY,
+        BEHAVIOR_DEAD,
+        BEHAVIOR_PLANT,
+        BEHAVIOR_MEAT,
+        BEHAVIOR_SAME,
+        BEHAVIOR_OTHER,
+        BEHAVIOR_WEAK,
+        BEHAVIOR_QUANTITY
+    };
+
+    static const char* GetBehaviorName(int behavior)
+    {
+        static const char* names[BEHAVIOR_QUANTITY] {
+            "", "attacked", "division", "wall", "empty", "dead", "plant", "meat", "same cell", "other cell", "weak"
+        };
+
+        if (behavior < 0 || behavior >= BEHAVIOR_QUANTITY)
+            return "";
+
+        return names[behavior];
+    }
+
+    CellStore() {}
+
+    CellStore(const CellStore& src) = delete;
+    CellStore& operator=(const CellStore& r) = delete;
+
+    ~CellStore() {}
+
+    // blocks must be returned by Clear before the allocator is changed
+    void SetAllocator(mtrebi::Allocator* _allocator)
+    {
+        allocator = _allocator;
+    }
+
+    void Clear()
+    {
+        while (!blocks.empty())
+        {
+            FreeBlock();
+        }
+
+        quantity = 0;
+    }
+
+    std::uint32_t GetQuantity() const
+    {
+        return quantity;
+    }
+
+    // appends a cell with zero attributes, returns false if there isn't memory
+    bool Add(std::uint32_t& index)
+    {
+        if (!Prepare(1))
+            return false;
+
+        index = quantity++;
+        Place(index);
+
+        return true;
+    }
+
+    // Takes blocks for the rows [quantity, quantity + rows), so cells may be
+    // placed there at once by several threads before they are appended (see
+    // Place and Append). Returns false if there isn't memory.
+    bool Prepare(std::uint32_t rows)
+    {
+        while (static_cast<std::size_t>(quantity) + rows > blocks.size()*CellBlock::size)
+        {
+            void* memory = allocator ? allocator->Allocate(sizeof(CellBlock), alignment) : nullptr;
+
+            if (memory == nullptr)
+                return false;
+
+            blocks.push_back(new(memory) CellBlock);
+        }
+
+        return true;
+    }
+
+    // sets zero attributes to a prepared row after the last cell
+    void Place(std::uint32_t index)
+    {
+        CellBlock& b = Block(index);
+        const int i = index & CellBlock::mask;
+
+        b.position[i] = Point(0,0);
+        b.energy[i] = 0;
+        b.age[i] = 0;
+        b.lifeTime[i] = 0;
+        b.divEnergy[i] = 0;
+        b.damage[i] = 0;
+        b.mutationProbability[i] = 0;
+        b.id[i] = -1;
+        b.slot[i] = 0;
+        b.childrenCounter[i] = 0;
+        b.killsCounter[i] = 0;
+        b.eatenPlantsCounter[i] = 0;
+        b.eatenMeatCounter[i] = 0;
+        b.geneId[i] = 0;
+        b.species[i] = 0;
+        b.lineage[i] = std::numeric_limits<std::uint32_t>::max();
+        b.direction[i] = 0;
+        b.lastBehavior[i] = BEHAVIOR_NONE;
+        b.attacked[i] = false;
+        b.queued[i] = false;
+    }
+
+    // appends the cell of a prepared row, returns its index
+    std::uint32_t Append(std::uint32_t row)
+    {
+        Copy(row, quantity);
+
+        return quantity++;
+    }
+
+    void Copy(std::uint32_t from, std::uint32_t to)
+    {
+        CellBlock& f = Block(from);
+        CellBlock& t = Block(to);
+
+        const int i = from & CellBlock::mask;
+        const int j = to & CellBlock::mask;
+
+        t.position[j] = f.position[i];
+        t.energy[j] = f.energy[i];
+        t.age[j] = f.age[i];
+        t.lifeTime[j] = f.lifeTime[i];
+        t.divEnergy[j] = f.divEnergy[i];
+        t.damage[j] = f.damage[i];
+        t.mutationProbability[j] = f.mutationProbability[i];
+        t.id[j] = f.id[i];
+        t.slot[j] = f.slot[i];
+        t.childrenCounter[j] = f.childrenCounter[i];
+        t.killsCounter[j] = f.killsCounter[i];
+        t.eatenPlantsCounter[j] = f.eatenPlantsCounter[i];
+        t.eatenMeatCounter[j] = f.eatenMeatCounter[i];
+        t.geneId[j] = f.geneId[i];
+        t.species[j] = f.species[i];
+        t.lineage[j] = f.lineage[i];
+        t.direction[j] = f.direction[i];
+        t.lastBehavior[j] = f.lastBehavior[i];
+        t.attacked[j] = f.attacked[i];
+        t.queued[j] = f.queued[i];
+    }
+
+    // The cell order[i] becomes the cell i. Attributes are gathered one by one
+    // through scratch: the loads of a pass don't depend on each other, so
+    // misses of the cache overlap. The owner must fix references to all cells.
+    void Permute(const std::vector<std::uint32_t>& order, std::vector<CellBlock>& scratch)
+    {
+        scratch.resize(blocks.size());
+
+        Gather(&CellBlock::position, order, scratch);
+        Gather(&CellBlock::energy, order, scratch);
+        Gather(&CellBlock::age, order, scratch);
+        Gather(&CellBlock::lifeTime, order, scratch);
+        Gather(&CellBlock::divEnergy, order, scratch);
+        Gather(&CellBlock::damage, order, scratch);
+        Gather(&CellBlock::mutationProbability, order, scratch);
+        Gather(&CellBlock::id, order, scratch);
+        Gather(&CellBlock::slot, order, scratch);
+        Gather(&CellBlock::childrenCounter, order, scratch);
+        Gather(&CellBlock::killsCounter, order, scratch);
+        Gather(&CellBlock::eatenPlantsCounter, order, scratch);
+        Gather(&CellBlock::eatenMeatCounter, order, scratch);
+        Gather(&CellBlock::geneId, order, scratch);
+        Gather(&CellBlock::species, order, scratch);
+        Gather(&CellBlock::lineage, order, scratch);
+        Gather(&CellBlock::direction, order, scratch);
+        Gather(&CellBlock::lastBehavior, order, scratch);
+        Gather(&CellBlock::attacked, order, scratch);
+        Gather(&CellBlock::queued, order, scratch);
+    }
+
+    // removes the last cell
+    void PopBack()
+    {
+        quantity--;
+        Shrink();
+    }
+
+    // returns blocks which were prepared but not used, one empty block stays
+    void Shrink()
+    {
+        while (blocks.size() >= 2 && quantity <= (blocks.size()-2)*CellBlock::size)
+        {
+            FreeBlock();
+        }
+    }
+
+    Point& Position(std::uint32_t c) { return Block(c).position[c & CellBlock::mask]; }
+
+    int& Energy(std::uint32_t c) { return Block(c).energy[c & CellBlock::mask]; }
+    int& Age(std::uint32_t c) { return Block(c).age[c & CellBlock::mask]; }
+    int& LifeTime(std::uint32_t c) { return Block(c).lifeTime[c & CellBlock::mask]; }
+    int& DivEnergy(std::uint32_t c) { return Block(c).divEnergy[c & CellBlock::mask]; }
+    int& Damage(std::uint32_t c) { return Block(c).damage[c & CellBlock::mask]; }
+    int& MutationProbability(std::uint32_t c) { return Block(c).mutationProbability[c & CellBlock::mask]; }
+
+    int& Id(std::uint32_t c) { return Block(c).id[c & CellBlock::mask]; }
+    std::uint32_t& Slot(std::uint32_t c) { return Block(c).slot[c & CellBlock::mask]; }
+
+    int& ChildrenCounter(std::uint32_t c) { return Block(c).childrenCounter[c & CellBlock::mask]; }
+    int& KillsCounter(std::uint32_t c) { return Block(c).killsCounter[c & CellBlock::mask]; }
+    int& EatenPlantsCounter(std::uint32_t c) { return Block(c).eatenPlantsCounter[c & CellBlock::mask]; }
+    int& EatenMeatCounter(std::uint32_t c) { return Block(c).eatenMeatCounter[c & CellBlock::mask]; }
+
+    // a genotype, see genotype.h
+    std::uint16_t& GeneId(std::uint32_t c) { return Block(c).geneId[c & CellBlock::mask]; }
+    // a species in the registry of the world, see species.h
+    std::uint32_t& SpeciesId(std::uint32_t c) { return Block(c).species[c & CellBlock::mask]; }
+
+    // a node in the tree of descent of cells if it is kept, see lineage.h
+    std::uint32_t& Lineage(std::uint32_t c) { return Block(c).lineage[c & CellBlock::mask]; }
+
+    std::uint8_t& Direction(std::uint32_t c) { return Block(c).direction[c & CellBlock::mask]; }
+    std::uint8_t& LastBehavior(std::uint32_t c) { return Block(c).lastBehavior[c & CellBlock::mask]; }
+
+    bool& Attacked(std::uint32_t c) { return Block(c).attacked[c & CellBlock::mask]; }
+    bool& Queued(std::uint32_t c) { return Block(c).queued[c & CellBlock::mask]; }
+
+    bool IsDead(std::uint32_t c)
+    {
+        CellBlock& b = Block(c);
+        const int i = c & CellBlock::mask;
+
+        return (b.age[i] >= b.lifeTime[i]) || (b.energy[i] <= 0);
+    }
+
+    std::size_t GetBlocksQuantity() const
+    {
+        return blocks.size();
+    }
+
+    std::size_t GetMemoryUsage() const
+    {
+        return blocks.size()*sizeof(CellBlock) + blocks.capacity()*sizeof(CellBlock*);
+    }
+
+private:
+    static const std::size_t alignment {8};
+
+    CellBlock& Block(std::uint32_t c)
+    {
+        return *blocks[c >> CellBlock::shift];
+    }
+
+    template <typename T>
+    void Gather(T (CellBlock::*field)[CellBlock::size], const std::vector<std::uint32_t>& order, std::vector<CellBlock>& scratch)
+    {
+        for (std::uint32_t i=0; i<quantity; i++)
+        {
+            const std::uint32_t c = order[i];
+
+            (scratch[i >> CellBlock::shift].*field)[i & CellBlock::mask] = (Block(c).*field)[c & CellBlock::mask];
+        }
+
+        for (std::uint32_t i=0; i<quantity; i++)
+        {
+            (Block(i).*field)[i & CellBlock::mask] = (scratch[i >> CellBlock::shift].*field)[i & CellBlock::mask];
+        }
+    }
+
+    void FreeBlock()
+    {
+        CellBlock* block = blocks.back();
+        blocks.pop_back();
+
+        block->~CellBlock();
+        allocator->Free(block);
+    }
+
+private:
+    std::vector<CellBlock*> blocks;
+    std::uint32_t quantity {0};
+
+    mtrebi::Allocator* allocator {nullptr};
+};
+
+}
+
+#endif
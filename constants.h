@@ -9,15 +9,16 @@
 #ifndef _CONSTANTS_H_
 #define _CONSTANTS_H_
 
-#include <wx/string.h>
+#include <string>
 
 namespace ProtoPuddle
 {
 
-const wxString unknownValueStr = wxT("---");
+const std::string unknownValueStr = "---";
 
-const int maxWorldWidth {100};
-const int maxWorldHeight {100};
+// coordinates of a field fit into 16 bits
+const int maxWorldWidth {65535};
+const int maxWorldHeight {65535};
 
 }
 
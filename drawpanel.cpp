@@ -42,8 +42,7 @@ BasicDrawPanel::BasicDrawPanel(wxWindow* parent, wxWindowID id, const wxSize& si
 
 void BasicDrawPanel::onSize(wxSizeEvent& event)
 {
-    if (world)
-        world->SetPanelSize(event.GetSize());
+    panelSize = event.GetSize();
 
 #ifdef __WXMSW__
     paintNow();
@@ -54,7 +53,7 @@ void BasicDrawPanel::onSize(wxSizeEvent& event)
 void BasicDrawPanel::mouseReleased(wxMouseEvent& event)
 {
 	if (world)
-    	world->SelectEntityByPosition(world->PanelToWorld(event.GetPosition()));
+    	world->SelectEntityByPosition(PanelToWorld(event.GetPosition()));
 
     paintNow();
 
@@ -96,7 +95,7 @@ void BasicDrawPanel::softwareRender(wxDC* dc)
 		dc->Clear();
 
 		if (world)
-		    world->Draw(dc);
+		    DrawWorld(dc);
 	}
 /*
     if (renderer)
@@ -131,15 +130,226 @@ void BasicDrawPanel::softwareRender(wxDC* dc)
         gdc.Clear();
 
         if (world)
-            world->Draw(static_cast<wxDC*>(&gdc));
+            DrawWorld(static_cast<wxDC*>(&gdc));
     }
     else
     {
         dc->Clear();
 
         if (world)
-            world->Draw(dc);
+            DrawWorld(dc);
     }
 */
 }
 
+wxPoint BasicDrawPanel::WorldToPanel(const ProtoPuddle::Point& position)
+{
+    wxRect bbb = GetBoardBoundingBox();
+    wxSize field = GetFieldSize(bbb);
+
+    return wxPoint(paddingX+field.GetWidth()*position.x, paddingY+field.GetHeight()*position.y);
+}
+
+ProtoPuddle::Point BasicDrawPanel::PanelToWorld(const wxPoint& position)
+{
+    wxRect bbb = GetBoardBoundingBox();
+
+    if ( !bbb.Contains(position) )
+        return ProtoPuddle::Point(-1, -1);
+
+    wxSize field = GetFieldSize(bbb);
+
+    // the world is bigger than the panel
+    if ( field.GetWidth() == 0 || field.GetHeight() == 0 )
+        return ProtoPuddle::Point(-1, -1);
+
+    return ProtoPuddle::Point((position.x-paddingX)/field.GetWidth(), (position.y-paddingY)/field.GetHeight());
+}
+
+wxSize BasicDrawPanel::GetFieldSize(const wxRect& board)
+{
+    const ProtoPuddle::Size& worldSize = world->GetSize();
+
+    return wxSize(board.GetWidth()/worldSize.GetWidth(), board.GetHeight()/worldSize.GetHeight());
+}
+
+wxRect BasicDrawPanel::GetBoardBoundingBox()
+{
+    const int padding = 10;
+
+    const ProtoPuddle::Size& worldSize = world->GetSize();
+
+    wxSize tmp = panelSize - wxSize(padding*2,padding*2);
+
+    int px = tmp.GetWidth() % worldSize.GetWidth();
+    int py = tmp.GetHeight() % worldSize.GetHeight();
+
+    int w = tmp.GetWidth() - px;
+    int h = tmp.GetHeight() - py;
+
+    paddingX = padding + px/2;
+    paddingY = padding + py/2;
+
+    return wxRect(paddingX, paddingY, w, h);
+}
+
+void BasicDrawPanel::DrawWorld(wxDC* dc)
+{
+    wxSize field = GetFieldSize(GetBoardBoundingBox());
+
+    // a field must take one pixel at least, big worlds can't be drawn
+    if ( field.GetWidth() == 0 || field.GetHeight() == 0 )
+        return;
+
+    DrawBoard(dc);
+    DrawEntities(dc);
+}
+
+void BasicDrawPanel::DrawBoard(wxDC* dc)
+{
+    wxRect bbb = GetBoardBoundingBox();
+    wxSize field = GetFieldSize(bbb);
+
+    // draw border
+    dc->SetPen( wxPen( wxColor(0,0,0), 2 ) );
+    dc->DrawRectangle( bbb );
+
+    // draw vertical lines
+    dc->SetPen( wxPen( wxColor(0,0,0), 1 ) );
+
+    for (int i=bbb.GetX()+field.GetWidth(); i<(bbb.GetX()+bbb.GetWidth()); i+=field.GetWidth())
+    {
+        dc->DrawLine( i, bbb.GetY(), i, bbb.GetY()+bbb.GetHeight() );
+    }
+
+    // draw horizontal lines
+    for (int i=bbb.GetY()+field.GetHeight(); i<(bbb.GetY()+bbb.GetHeight()); i+=field.GetHeight())
+    {
+        dc->DrawLine( bbb.GetX(), i, bbb.GetX()+bbb.GetWidth(), i );
+    }
+}
+
+void BasicDrawPanel::DrawEntities(wxDC* dc)
+{
+    const ProtoPuddle::Size& worldSize = world->GetSize();
+
+    for (int i=0; i<worldSize.GetWidth(); i++)
+    {
+        for (int j=0; j<worldSize.GetHeight(); j++)
+        {
+            ProtoPuddle::EntityView e = world->GetEntityByPosition(ProtoPuddle::Point(i,j));
+
+            if (e)
+                DrawEntity(dc, e, false);
+        }
+    }
+
+    ProtoPuddle::EntityView se = world->GetSelectedEntity();
+
+    if (se)
+        DrawEntity(dc, se, true);
+}
+
+void BasicDrawPanel::DrawEntity(wxDC* dc, const ProtoPuddle::EntityView& e, bool selected)
+{
+    const ProtoPuddle::Color c = e.GetColor();
+    wxColor color(c.r, c.g, c.b);
+
+    if (selected)
+    {
+        SetSelectedBrushAndPen(dc, color);
+    }
+    else
+    {
+        SetNormalBrushAndPen(dc, color);
+    }
+
+    switch (e.GetType())
+    {
+    case ProtoPuddle::EntityView::TYPE_PLANT:
+    case ProtoPuddle::EntityView::TYPE_MEAT:
+        DrawCircle(dc, e.GetPosition());
+        break;
+    case ProtoPuddle::EntityView::TYPE_CELL:
+        DrawRectangle(dc, e.GetPosition());
+
+        if (!selected)
+        {
+            DrawDirection(dc, e.GetPosition(), e.GetDirection());
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void BasicDrawPanel::SetSelectedBrushAndPen(wxDC* dc, const wxColor& color)
+{
+    wxBrush brush;
+    wxPen pen;
+
+    brush.SetStyle(wxBRUSHSTYLE_CROSSDIAG_HATCH);
+    brush.SetColour(wxColor(255,255,255));
+
+    pen.SetColour(color);
+    pen.SetWidth(2);
+
+    dc->SetBrush(brush);
+    dc->SetPen(pen);
+}
+
+void BasicDrawPanel::SetNormalBrushAndPen(wxDC* dc, const wxColor& color)
+{
+    wxBrush brush;
+    wxPen pen;
+
+    brush.SetStyle(wxBRUSHSTYLE_SOLID);
+    brush.SetColour(color);
+
+    pen.SetColour(color);
+
+    dc->SetBrush(brush);
+    dc->SetPen(pen);
+}
+
+void BasicDrawPanel::DrawCircle(wxDC* dc, const ProtoPuddle::Point& position)
+{
+    wxRect bbb = GetBoardBoundingBox();
+    wxSize field = GetFieldSize(bbb);
+
+    int radius = field.GetHeight()/3;
+
+    wxPoint p = WorldToPanel(position);
+    dc->DrawCircle(p.x+field.GetWidth()/2, p.y+field.GetHeight()/2, radius);
+}
+
+void BasicDrawPanel::DrawRectangle(wxDC* dc, const ProtoPuddle::Point& position)
+{
+    wxRect bbb = GetBoardBoundingBox();
+    wxSize field = GetFieldSize(bbb);
+
+    int w = int(field.GetWidth()*0.8f);
+    int h = int(field.GetHeight()*0.8f);
+
+    wxPoint p = WorldToPanel(position);
+
+    p.x += field.GetWidth()/2 - w/2;
+    p.y += field.GetHeight()/2 - h/2;
+
+    dc->DrawRectangle(p.x, p.y, w, h);
+}
+
+void BasicDrawPanel::DrawDirection(wxDC* dc, const ProtoPuddle::Point& position, const ProtoPuddle::Point& direction)
+{
+    wxRect bbb = GetBoardBoundingBox();
+    wxSize field = GetFieldSize(bbb);
+
+    wxPoint a = WorldToPanel(position);
+
+    a.x += field.GetWidth() / 2;
+    a.y += field.GetHeight() / 2;
+
+    wxPoint b(a.x+direction.x*field.GetWidth(), a.y+direction.y*field.GetHeight());
+
+    dc->DrawLine(a, b);
+}
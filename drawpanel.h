@@ -45,9 +45,26 @@ public:
 
     bool SwitchAntialiasingMode();
 
+    wxPoint WorldToPanel(const ProtoPuddle::Point& position);
+    ProtoPuddle::Point PanelToWorld(const wxPoint& position);
+
 private:
     void softwareRender(wxDC* dc);
 
+    wxSize GetFieldSize(const wxRect& board);
+    wxRect GetBoardBoundingBox();
+
+    void DrawWorld(wxDC* dc);
+    void DrawBoard(wxDC* dc);
+    void DrawEntities(wxDC* dc);
+    void DrawEntity(wxDC* dc, const ProtoPuddle::EntityView& e, bool selected);
+
+    void SetSelectedBrushAndPen(wxDC* dc, const wxColor& color);
+    void SetNormalBrushAndPen(wxDC* dc, const wxColor& color);
+    void DrawCircle(wxDC* dc, const ProtoPuddle::Point& position);
+    void DrawRectangle(wxDC* dc, const ProtoPuddle::Point& position);
+    void DrawDirection(wxDC* dc, const ProtoPuddle::Point& position, const ProtoPuddle::Point& direction);
+
 private:
     wxGraphicsRenderer* renderer {nullptr};
 
@@ -56,6 +73,11 @@ private:
 
     ProtoPuddle::World* world {nullptr};
 
+    wxSize panelSize {wxSize(0,0)};
+
+    int paddingX {0};
+    int paddingY {0};
+
     bool antialiasingFlag {true};
 };
 
@@ -0,0 +1,238 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:               emptypoints.h
+// Description:        Set of empty fields of the world (occupancy bitmap)
+// Author:             Alexey Orlov (https://github.com/m110h)
+// Last modification:  18/08/2020
+// Licence:            MIT licence
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _EMPTY_POINTS_H_
+#define _EMPTY_POINTS_H_
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "types.h"
+#include "random.h"
+
+namespace ProtoPuddle
+{
+
+// One bit per field, a set bit means the field is empty. Fields are grouped
+// into blocks of blockWords*64 bits, quantities of empty fields of blocks are
+// kept in a Fenwick tree, so the k-th empty field is found without scanning
+// the whole bitmap.
+//
+// Lease and release of a known field are a bit test plus a counter update.
+// A random field is taken by rejection sampling first (a few uniform probes
+// over the whole world, each accepted probe is uniform over empty fields),
+// and by rank/select over the Fenwick tree when the world is almost full.
+class EmptyPoints
+{
+public:
+    EmptyPoints() {}
+
+    EmptyPoints(const EmptyPoints& src) = delete;
+    EmptyPoints& operator=(const EmptyPoints& r) = delete;
+
+    ~EmptyPoints() {}
+
+    // all fields are empty after reset
+    void Reset(int _width, int _height)
+    {
+        width = _width;
+        height = _height;
+
+        area = static_cast<std::size_t>(width) * height;
+
+        const std::size_t words = (area + 63) / 64;
+        const std::size_t blocks = (words + blockWords - 1) / blockWords;
+
+        bits.assign(words, ~std::uint64_t(0));
+
+        // clear bits after the last field
+        if (area % 64)
+        {
+            bits.back() = (std::uint64_t(1) << (area % 64)) - 1;
+        }
+
+        tree.assign(blocks + 1, 0);
+
+        for (std::size_t i=0; i<words; i++)
+        {
+            tree[i/blockWords + 1] += static_cast<std::uint32_t>(__builtin_popcountll(bits[i]));
+        }
+
+        // linear construction of the Fenwick tree
+        for (std::size_t i=1; i<tree.size(); i++)
+        {
+            std::size_t parent = i + (i & (~i + 1));
+
+            if (parent < tree.size())
+                tree[parent] += tree[i];
+        }
+
+        topBit = 1;
+        while ((topBit << 1) <= blocks)
+            topBit <<= 1;
+
+        quantity = area;
+    }
+
+    void Clear()
+    {
+        bits.clear();
+        bits.shrink_to_fit();
+
+        tree.clear();
+        tree.shrink_to_fit();
+
+        area = 0;
+        quantity = 0;
+    }
+
+    std::size_t GetQuantity() const
+    {
+        return quantity;
+    }
+
+    bool IsEmpty(const Point& p) const
+    {
+        const std::size_t index = Index(p);
+        return (bits[index >> 6] >> (index & 63)) & 1;
+    }
+
+    bool Lease(const Point& p)
+    {
+        return LeaseIndex(Index(p));
+    }
+
+    void Release(const Point& p)
+    {
+        const std::size_t index = Index(p);
+        const std::uint64_t mask = std::uint64_t(1) << (index & 63);
+
+        if (bits[index >> 6] & mask)
+            return;
+
+        bits[index >> 6] |= mask;
+        Update(index, 1);
+    }
+
+    // returns Point(-1,-1) if the world hasn't empty fields
+    Point LeaseRandom(Random& random)
+    {
+        if (quantity == 0)
+            return Point(-1, -1);
+
+        for (int i=0; i<probes; i++)
+        {
+            std::size_t index = static_cast<std::size_t>(random.Below(area));
+
+            if (LeaseIndex(index))
+                return ToPoint(index);
+        }
+
+        std::size_t index = Select(static_cast<std::size_t>(random.Below(quantity)));
+        LeaseIndex(index);
+
+        return ToPoint(index);
+    }
+
+    std::size_t GetMemoryUsage() const
+    {
+        return bits.capacity()*sizeof(std::uint64_t) + tree.capacity()*sizeof(std::uint32_t);
+    }
+
+private:
+    static const std::size_t blockWords {64};
+    static const int probes {4};
+
+    std::size_t Index(const Point& p) const
+    {
+        return static_cast<std::size_t>(p.y) * width + p.x;
+    }
+
+    Point ToPoint(std::size_t index) const
+    {
+        return Point(static_cast<int>(index % width), static_cast<int>(index / width));
+    }
+
+    bool LeaseIndex(std::size_t index)
+    {
+        const std::uint64_t mask = std::uint64_t(1) << (index & 63);
+
+        if (!(bits[index >> 6] & mask))
+            return false;
+
+        bits[index >> 6] &= ~mask;
+        Update(index, -1);
+
+        return true;
+    }
+
+    void Update(std::size_t index, int delta)
+    {
+        quantity += delta;
+
+        for (std::size_t i = (index >> 6)/blockWords + 1; i < tree.size(); i += i & (~i + 1))
+        {
+            tree[i] += delta;
+        }
+    }
+
+    // returns an index of the k-th (from zero) empty field
+    std::size_t Select(std::size_t k) const
+    {
+        // find a block by the Fenwick tree
+        std::size_t block = 0;
+
+        for (std::size_t step = topBit; step > 0; step >>= 1)
+        {
+            if (block + step < tree.size() && tree[block + step] <= k)
+            {
+                block += step;
+                k -= tree[block];
+            }
+        }
+
+        // find a word inside the block
+        std::size_t word = block*blockWords;
+
+        for (;; word++)
+        {
+            std::size_t count = static_cast<std::size_t>(__builtin_popcountll(bits[word]));
+
+            if (k < count)
+                break;
+
+            k -= count;
+        }
+
+        // find a bit inside the word
+        std::uint64_t w = bits[word];
+
+        for (; k > 0; k--)
+        {
+            w &= w - 1;
+        }
+
+        return word*64 + static_cast<std::size_t>(__builtin_ctzll(w));
+    }
+
+private:
+    int width {0};
+    int height {0};
+
+    std::size_t area {0};
+    std::size_t quantity {0};
+    std::size_t topBit {1};
+
+    std::vector<std::uint64_t> bits;
+    std::vector<std::uint32_t> tree;
+};
+
+}
+
+#endif
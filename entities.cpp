@@ -6,36 +6,184 @@
 // Licence:            MIT licence
 /////////////////////////////////////////////////////////////////////////////
 
-#include "wx/wxprec.h"
-
-#ifndef WX_PRECOMP
-#include <wx/wx.h>
-#endif
-
-#include <wx/dcbuffer.h>
-
 #include "entities.h"
+#include "logger.h"
 
-#include "thirdparty/allocator/freelistallocator.h"
+#include "poolallocator.h"
 
+#include <cassert>
+#include <memory>
 #include <array>
 #include <limits>
 #include <iomanip>
 #include <fstream>
 #include <algorithm>
+#include <tuple>
 #include <chrono>
+#include <functional>
 
 namespace ProtoPuddle
 {
 
-static Entity* entitiesTable[maxWorldWidth][maxWorldHeight] = {nullptr};
-static mtrebi::FreeListAllocator _allocator(sizeof(Cell)*(maxWorldWidth*maxWorldHeight), mtrebi::FreeListAllocator::FIND_FIRST);
-static const std::size_t _alignment = 8;
+// it is created by World::New(), its limit depends on the world's area and
+// its pages follow the quantity of cells; all its chunks are blocks of cells
+static std::unique_ptr<PoolAllocator> _allocator;
+
+// directions of cells, a turn to the left or to the right is a step back or
+// forward in the table
+static const std::array<Point,8> _directions {
+    Point(1,0),
+    Point(1,1),
+    Point(0,1),
+    Point(-1,1),
+    Point(-1,0),
+    Point(-1,-1),
+    Point(0,-1),
+    Point(1,-1)
+};
+
+// bits of x and y are interleaved, so fields which are close in the world
+// are mostly close in the order
+static std::uint32_t MortonCode(const Point& p)
+{
+    auto spread = [](std::uint32_t v) {
+        v &= 0xffff;
+        v = (v | (v << 8)) & 0x00ff00ff;
+        v = (v | (v << 4)) & 0x0f0f0f0f;
+        v = (v | (v << 2)) & 0x33333333;
+        v = (v | (v << 1)) & 0x55555555;
+
+        return v;
+    };
+
+    return spread(static_cast<std::uint32_t>(p.x)) | (spread(static_cast<std::uint32_t>(p.y)) << 1);
+}
+
+static const Color _plantColor {Color(43,168,74)};
+static const Color _meatColor {Color(205,83,59)};
+
+// ENTITY VIEW
+
+int EntityView::GetType() const
+{
+    return World::RefType(ref);
+}
+
+int EntityView::GetId() const
+{
+    if (GetType() != TYPE_CELL)
+        return -1;
+
+    return world->cells.Id(World::RefIndex(ref));
+}
+
+Color EntityView::GetColor() const
+{
+    switch (GetType())
+    {
+    case TYPE_PLANT:
+        return _plantColor;
+    case TYPE_MEAT:
+        return _meatColor;
+    default:
+        break;
+    }
+
+    return world->speciesRegistry.Get(world->cells.SpeciesId(World::RefIndex(ref))).color;
+}
+
+Point EntityView::GetPosition() const
+{
+    return position;
+}
+
+Point EntityView::GetDirection() const
+{
+    if (GetType() != TYPE_CELL)
+        return Point(0,0);
+
+    return _directions[world->cells.Direction(World::RefIndex(ref))];
+}
+
+Gene EntityView::GetGene() const
+{
+    if (GetType() != TYPE_CELL)
+        return Gene();
+
+    const std::uint32_t c = World::RefIndex(ref);
+
+    const Species& species = world->speciesRegistry.Get(world->cells.SpeciesId(c));
+
+    return Gene(world->geneNames[species.geneName], Genotype::Decode(world->cells.GeneId(c)));
+}
+
+Handle EntityView::GetHandle() const
+{
+    if (GetType() != TYPE_CELL)
+        return Handle();
+
+    return world->GetHandle(ref);
+}
+
+std::string EntityView::Get(const std::string& name) const
+{
+    const std::uint32_t index = World::RefIndex(ref);
+
+    if (GetType() != TYPE_CELL)
+    {
+        const SimParams& params = world->GetParams();
+        const int lifeTime = (GetType() == TYPE_PLANT) ? params.plantLifeTime : params.meatLifeTime;
+
+        // age of plants and meat follows from their expiry
+        if (name == "age")
+            return std::to_string(std::max(0, lifeTime - world->GetTimeLeft(ref)));
+        if (name == "maxAge")
+            return std::to_string(lifeTime);
+        if (name == "energy")
+            return std::to_string(World::FoodEnergy(ref));
+
+        return unknownValueStr;
+    }
+
+    CellStore& cells = world->cells;
+
+    if (name == "id")
+        return std::to_string(cells.Id(index));
+    if (name == "age")
+        return std::to_string(cells.Age(index));
+    if (name == "maxAge")
+        return std::to_string(cells.LifeTime(index));
+    if (name == "energy")
+        return std::to_string(cells.Energy(index));
+    if (name == "divEnergy")
+        return std::to_string(cells.DivEnergy(index));
+    if (name == "mutation")
+        return std::to_string(cells.MutationProbability(index));
+    if (name == "damage")
+        return std::to_string(cells.Damage(index));
+    if (name == "kills")
+        return std::to_string(cells.KillsCounter(index));
+    if (name == "childrens")
+        return std::to_string(cells.ChildrenCounter(index));
+    if (name == "eatenPlants")
+        return std::to_string(cells.EatenPlantsCounter(index));
+    if (name == "eatenMeat")
+        return std::to_string(cells.EatenMeatCounter(index));
+    if (name == "lastBehavior")
+        return CellStore::GetBehaviorName(cells.LastBehavior(index));
+    if (name == "species")
+        return std::to_string(cells.SpeciesId(index));
+
+    return unknownValueStr;
+}
 
-World::World(wxFrame* _parentFrame, GlobalProperties* _properties): parentFrame(_parentFrame)
+// WORLD
+
+World::World(GlobalProperties* _properties)
 {
     SetProperties(_properties);
-    _allocator.Init();
+
+    contexts.resize(1);
 }
 
 World::~World()
@@ -48,7 +196,7 @@ void World::New()
 {
     steps = 0;
     nextId = 0;
-    selectedId = -1;
+    selected = Handle();
 
     plantsCounter = 0;
     meatCounter = 0;
@@ -56,42 +204,393 @@ void World::New()
 
     ClearEntitiesTable();
 
-    _allocator.Reset();
+    ApplyProperties();
+
+    if (!seedFixed)
+        seed = static_cast<std::uint64_t>(std::chrono::system_clock::now().time_since_epoch().count());
+
+    worldSize.SetWidth(params.worldWidth);
+    worldSize.SetHeight(params.worldHeight);
+
+    entitiesTable.Reset(worldSize.GetWidth(), worldSize.GetHeight());
+    scheduler.Reset(worldSize.GetWidth(), worldSize.GetHeight());
+    scheduler.Seed(Random(seed, 0, 0, RANDOM_ORDER)());
 
-    worldSize.SetWidth(properties->GetValue(wxString("worldWidth")));
-    worldSize.SetHeight(properties->GetValue(wxString("worldHeight")));
+    // One cell per field at most and as many rows of children in rooms
+    // during a step; references to cells have refShift bits for indices. A
+    // spare block is kept by the store of cells when it shrinks. The limit
+    // only bounds pages, they are mapped as the population grows.
+    const std::size_t area = static_cast<std::size_t>(worldSize.GetWidth()) * worldSize.GetHeight();
+    const std::size_t rows = std::min(2*area, static_cast<std::size_t>(refMask) + 1);
+    const std::size_t blocks = (rows + CellBlock::size - 1) / CellBlock::size + 1;
+
+    _allocator.reset(new PoolAllocator(sizeof(CellBlock), blocks));
+    _allocator->Init();
+
+    cells.SetAllocator(_allocator.get());
+
+    cellLineageEnabled = lineageCellsOption;
+
+    speciesLineage.SetBudget(lineageBudgetOption);
+    cellLineage.SetBudget(lineageBudgetOption);
+
+    if (lineageLogFile.empty())
+    {
+        lineageLog.Close();
+    }
+    else if (!lineageLog.Open(lineageLogFile))
+    {
+        Logger::Message("World::New (Error): can't open the lineage log " + lineageLogFile + ".");
+    }
 
     GenerateEmptyPoints();
 
-    GenerateEntities(Entity::TYPE_PLANT, properties->GetValue(wxString("plants")));
-    GenerateEntities(Entity::TYPE_CELL, properties->GetValue(wxString("sortsOfCell")));
+    Random random(seed, 0, 0, RANDOM_NEW);
+
+    GenerateEntities(EntityView::TYPE_PLANT, params.plants, random);
+    GenerateEntities(EntityView::TYPE_CELL, params.sortsOfCell, random);
 }
 
 void World::StepEntities()
 {
-    Entity* entities[worldSize.GetWidth()*worldSize.GetHeight()];
+    // children are appended to the store during the step, they will act
+    // from the next step
+    if (scheduler.GetPolicy() == Scheduler::ORDER_SYNCHRONOUS)
+    {
+        StepSynchronous();
+    }
+    else
+    {
+        StepTiles();
+    }
+
+    // plants and meat don't act, they are touched only when they expire
+    expiryWheel.Advance([this](const Point& p) {
+        const std::uint32_t ref = entitiesTable.Get(p);
+
+        if (RefType(ref) == EntityView::TYPE_CELL || ref == 0)
+            return;
+
+        if (FoodExpiry(ref) == (expiryWheel.GetNow() & foodExpiryMask))
+            KillEntity(p, stepContext);
+    });
+
+    ApplyContext();
+
+    // rooms of children are taken for every cell which could divide
+    cells.Shrink();
+}
+
+// Tiles of a colour are stepped at once, a cell stays in its tile till its
+// own action, so a cell acts once. A worker writes only fields and rows of
+// cells around its tile; children are placed into the room of the tile and
+// everything else is recorded in the context of the worker. After a phase
+// children are born and records are merged in the order of tiles, so the
+// world doesn't depend on the quantity of workers and on which of them ran
+// a tile.
+void World::StepTiles()
+{
+    const std::uint32_t n = cells.GetQuantity();
+
+    auto position = [this](std::uint32_t c) -> const Point& {
+        return cells.Position(c);
+    };
+
+    scheduler.Partition(n, position, tileShift);
+
+    // chunks of the grid are allocated before workers write into them: a
+    // cell reaches its neighbours and chunks are wider than two fields
+    for (std::uint32_t c=0; c<n; c++)
+    {
+        const Point& p = cells.Position(c);
+
+        const int left = std::max(p.x - 1, 0);
+        const int right = std::min(p.x + 1, worldSize.GetWidth() - 1);
+        const int top = std::max(p.y - 1, 0);
+        const int bottom = std::min(p.y + 1, worldSize.GetHeight() - 1);
+
+        entitiesTable.Allocate(Point(left, top));
+        entitiesTable.Allocate(Point(right, top));
+        entitiesTable.Allocate(Point(left, bottom));
+        entitiesTable.Allocate(Point(right, bottom));
+    }
+
+    const std::size_t tiles = scheduler.GetTilesQuantity();
+
+    tileRuns.resize(tiles);
+
+    // a cell divides once a step, so children of a phase are fewer than
+    // cells; the buffer follows the population
+    births.resize(n);
+
+    for (int colour=0; colour<Scheduler::colours; colour++)
+    {
+        // a cell may divide if it has enough energy before the phase: only
+        // its own action adds energy to it
+        birthsFirst = cells.GetQuantity();
+
+        std::uint32_t room = birthsFirst;
+
+        for (std::size_t tile=0; tile<tiles; tile++)
+        {
+            TileRun& run = tileRuns[tile];
+
+            run.room = room;
+
+            scheduler.RunTile(colour, tile, [this, &room](std::uint32_t c) {
+                if (cells.Energy(c) >= cells.DivEnergy(c))
+                    room++;
+            });
+
+            run.roomEnd = room;
+        }
+
+        if (!cells.Prepare(room - birthsFirst))
+        {
+            Logger::Message("World::StepTiles (Critical): can't allocate memory for children.");
+
+            for (TileRun& run: tileRuns)
+                run.roomEnd = run.room;
+        }
+
+
+        workers.Run(tiles, [this, colour](std::size_t tile, int worker) {
+            TileRun& run = tileRuns[tile];
+            StepContext& context = contexts[worker];
+
+            run.worker = worker;
+            run.first = context.Mark();
+
+            context.roomNext = run.room;
+            context.roomEnd = run.roomEnd;
+
+            scheduler.RunTile(colour, tile, [this, &context](std::uint32_t c) {
+                StepCell(c, context);
+            });
+
+            run.roomNext = context.roomNext;
+            run.last = context.Mark();
+        });
+
+        for (const TileRun& run: tileRuns)
+            BearChildren(run.room, run.roomNext, stepContext);
+
+        for (const TileRun& run: tileRuns)
+            MergeRecords(run);
+
+        for (StepContext& context: contexts)
+            context.Clear();
+    }
+}
+
+void World::BearChildren(std::uint32_t first, std::uint32_t last, StepContext& context)
+{
+    for (std::uint32_t row=first; row<last; row++)
+    {
+        Birth& birth = births[row - birthsFirst];
+
+        const std::uint32_t c = birth.parent;
+        const std::uint32_t child = cells.Append(row);
+
+        birth.row = child;
+
+        cells.Id(child) = GetNextId();
+
+        // energy of the child changed after the division was booked to the
+        // species of the parent, AddCell books all of it
+        if (cells.Energy(child) != birth.energy)
+            context.energy.emplace_back(cells.SpeciesId(child), birth.energy - cells.Energy(child));
+
+        if (birth.locus != LineageRecord::noLocus)
+        {
+            const std::uint32_t parent = cells.SpeciesId(c);
+
+            cells.SpeciesId(child) = FoundSpecies(birth.color, speciesRegistry.Get(parent).geneName, parent, birth.locus);
+        }
+
+        if (cellLineageEnabled)
+            cells.Lineage(child) = cellLineage.Add(cells.Lineage(c), static_cast<std::uint32_t>(cells.Id(child)), steps, birth.locus);
+
+        AddCell(child, context);
+    }
+}
+
+void World::MergeRecords(const TileRun& run)
+{
+    const StepContext& from = contexts[run.worker];
+
+    // a dead child is known by its row in the room
+    for (std::size_t i=run.first.deadCells; i<run.last.deadCells; i++)
+    {
+        const std::uint32_t c = RefIndex(from.deadCells[i]);
+
+        if (c < birthsFirst)
+            stepContext.deadCells.push_back(from.deadCells[i]);
+        else
+            stepContext.deadCells.push_back(MakeRef(EntityView::TYPE_CELL, births[c - birthsFirst].row));
+    }
+
+    stepContext.deadFood.insert(stepContext.deadFood.end(), from.deadFood.begin() + run.first.deadFood, from.deadFood.begin() + run.last.deadFood);
+    stepContext.fields.insert(stepContext.fields.end(), from.fields.begin() + run.first.fields, from.fields.begin() + run.last.fields);
+    stepContext.energy.insert(stepContext.energy.end(), from.energy.begin() + run.first.energy, from.energy.begin() + run.last.energy);
+}
+
+// Cells decide on the same state of the world, then their actions are
+// applied in the order of indices. Moves and divisions into a field and meals
+// of a food are contested: the cell with the lowest hash of its id and the
+// step wins, the others stay idle. Attacks follow all other actions, so a
+// victim is hit wherever it has moved. Deciding doesn't change the world, it
+// is shared by the workers; nothing depends on the quantity of them.
+void World::StepSynchronous()
+{
+    const std::uint32_t n = cells.GetQuantity();
+    const std::uint32_t batch = 4096;
+
+    intents.resize(n);
+
+    workers.Run((n + batch - 1) / batch, [this, n, batch](std::size_t task, int) {
+        const std::uint32_t first = static_cast<std::uint32_t>(task) * batch;
+        const std::uint32_t last = std::min(n, first + batch);
+
+        for (std::uint32_t c=first; c<last; c++)
+            intents[c] = Sense(c);
+    });
+
+    contenders.clear();
+
+    for (std::uint32_t c=0; c<n; c++)
+    {
+        const std::uint8_t action = intents[c].action;
+
+        if (action != Gene::ACTION_MOVE && action != Gene::ACTION_EAT && action != Intent::divide)
+            continue;
+
+        const Point p = cells.Position(c) + _directions[cells.Direction(c)];
+
+        // a murmur3 finalizer of the id and the step
+        std::uint32_t h = static_cast<std::uint32_t>(cells.Id(c)) ^ (static_cast<std::uint32_t>(steps) * 0x9e3779b9u);
+
+        h ^= h >> 16;
+        h *= 0x85ebca6bu;
+        h ^= h >> 13;
+        h *= 0xc2b2ae35u;
+        h ^= h >> 16;
+
+        contenders.push_back({ static_cast<std::uint64_t>(p.y)*worldSize.GetWidth() + p.x, h, c });
+    }
+
+    std::sort(contenders.begin(), contenders.end(), [](const Contender& a, const Contender& b) {
+        return std::tie(a.field, a.priority, a.cell) < std::tie(b.field, b.priority, b.cell);
+    });
+
+    for (std::size_t i=1; i<contenders.size(); i++)
+    {
+        if (contenders[i].field == contenders[i-1].field)
+            intents[contenders[i].cell].action = Gene::ACTION_NONE;
+    }
+
+    StepContext& context = stepContext;
 
-    size_t count = 0;
+    // children wait in the room till all cells acted, like in tiles
+    birthsFirst = n;
 
-    for (int i=0; i<worldSize.GetWidth(); i++)
+    context.roomNext = n;
+    context.roomEnd = n + static_cast<std::uint32_t>(std::count_if(intents.begin(), intents.end(), [](const Intent& intent) {
+        return intent.action == Intent::divide;
+    }));
+
+    if (!cells.Prepare(context.roomEnd - n))
     {
-        for (int j=0; j<worldSize.GetHeight(); j++)
+        Logger::Message("World::StepSynchronous (Critical): can't allocate memory for children.");
+        context.roomEnd = n;
+    }
+
+    births.resize(n);
+
+    for (std::uint32_t c=0; c<n; c++)
+    {
+        if (intents[c].action != Intent::skip)
+            cells.Age(c)++;
+
+        switch (intents[c].action)
         {
-            if (entitiesTable[i][j])
-            {
-                entities[count] = entitiesTable[i][j];
-                count++;
-            }
+        case Intent::skip:
+        case Gene::ACTION_NONE:
+        case Gene::ACTION_ATTACK:
+            break;
+        case Intent::divide:
+            Clone(c, context);
+            break;
+        default:
+            Execute(c, intents[c].action, context);
+            break;
         }
     }
 
-    static unsigned seed = std::chrono::system_clock::now().time_since_epoch().count();
-    std::shuffle(entities, entities + count, std::default_random_engine(seed));
+    for (std::uint32_t c=0; c<n; c++)
+    {
+        if (intents[c].action != Gene::ACTION_ATTACK)
+            continue;
+
+        const std::uint32_t victim = intents[c].victim;
+        const bool alive = !cells.IsDead(victim);
 
-    for (size_t i=0; i<count; i++)
+        Hit(c, victim, context);
+        AddEnergy(c, -params.attackEnergy, context);
+
+        if (alive && cells.IsDead(victim))
+            cells.KillsCounter(c)++;
+    }
+
+    for (std::uint32_t c=0; c<n; c++)
     {
-        entities[i]->Step();
+        if (cells.IsDead(c))
+            EnqueueDeath(MakeRef(EntityView::TYPE_CELL, c), context);
     }
+
+    BearChildren(n, context.roomNext, context);
+}
+
+void World::ApplyContext()
+{
+    StepContext& context = stepContext;
+
+    for (std::uint32_t ref: context.deadCells)
+        deadCells.push_back(RefIndex(ref));
+
+    // one by one: buffers of the step grow by doubling, an insertion of a
+    // range into the empty buffer would allocate its exact size on a record
+    for (const Point& p: context.deadFood)
+        deadFood.push_back(p);
+
+    // Lease and Release don't change a point which is already in the state
+    for (const Point& p: context.fields)
+    {
+        if (entitiesTable.Get(p) == 0)
+        {
+            ReleasePoint(p);
+        }
+        else
+        {
+            LeaseEmptyPoint(p);
+        }
+    }
+
+    for (const auto& [species, delta]: context.energy)
+        speciesRegistry.AddEnergy(species, delta);
+
+    context.Clear();
+}
+
+void World::SetThreads(int threads)
+{
+    workers.SetWorkers(threads);
+    contexts.resize(workers.GetWorkers());
+}
+
+int World::GetThreads() const
+{
+    return workers.GetWorkers();
 }
 
 void World::Step()
@@ -101,22 +600,28 @@ void World::Step()
         steps = 0;
     }
 
-    GenerateEntities(Entity::TYPE_PLANT, properties->GetValue(wxString("plantsPerStep")));
+    Random random(seed, static_cast<std::uint64_t>(steps), 0, RANDOM_PLANTS);
+
+    GenerateEntities(EntityView::TYPE_PLANT, params.plantsPerStep, random);
     StepEntities();
     DeathHandle();
 
+    // pages of cells which stayed free for a while are returned
+    _allocator->Trim();
+
     steps++;
-}
 
-void World::Draw(wxDC* dc)
-{
-    DrawBoard(dc);
-    DrawEntities(dc);
+    if (params.compactionInterval > 0 && steps % params.compactionInterval == 0)
+    {
+        CompactCells();
+    }
 }
 
 void World::SetProperties(GlobalProperties* _properties)
 {
     properties = _properties;
+
+    ApplyProperties();
 }
 
 GlobalProperties* World::GetProperties()
@@ -124,694 +629,606 @@ GlobalProperties* World::GetProperties()
     return properties;
 }
 
-bool World::IsInside(const wxPoint& worldPosition)
+void World::ApplyProperties()
+{
+    params.Compile(*properties);
+    scheduler.SetPolicy(params.updateOrder);
+}
+
+const SimParams& World::GetParams() const
+{
+    return params;
+}
+
+bool World::IsInside(const Point& worldPosition)
 {
     return (worldPosition.x >= 0) && (worldPosition.x < worldSize.GetWidth()) && (worldPosition.y >= 0) && (worldPosition.y < worldSize.GetHeight());
 }
 
-Entity* World::GetEntityByPosition(const wxPoint& worldPosition)
+EntityView World::GetEntityByPosition(const Point& worldPosition)
 {
-    return entitiesTable[worldPosition.x][worldPosition.y];
+    return EntityView(this, entitiesTable.Get(worldPosition), worldPosition);
 }
 
-int World::GetEntityIdByPosition(const wxPoint& worldPosition)
+int World::GetEntityIdByPosition(const Point& worldPosition)
 {
-    Entity* e = GetEntityByPosition(worldPosition);
+    EntityView e = GetEntityByPosition(worldPosition);
 
-    if (nullptr == e)
+    if (!e)
         return -1;
 
-    return e->GetId();
+    return e.GetId();
 }
 
-Entity* World::GetEntityById(int id)
+EntityView World::GetEntityById(int id)
 {
-    for (int i=0; i<worldSize.GetWidth(); i++)
-    {
-        for (int j=0; j<worldSize.GetHeight(); j++)
-        {
-            if ( (entitiesTable[i][j]) && (id == entitiesTable[i][j]->GetId()) )
-                return entitiesTable[i][j];
-        }
-    }
+    const std::uint32_t* slot = cellIds.Find(id);
+
+    if (slot == nullptr)
+        return EntityView();
 
-    return nullptr;
+    return GetEntity(entities.GetHandle(*slot));
 }
 
-void World::SelectEntityByPosition(const wxPoint& worldPosition)
+EntityView World::GetEntity(const Handle& handle)
 {
-    selectedId = GetEntityIdByPosition(worldPosition);
+    const std::uint32_t* ref = entities.Get(handle);
+
+    if (ref == nullptr)
+        return EntityView();
+
+    return EntityView(this, *ref, cells.Position(RefIndex(*ref)));
 }
 
-Entity* World::GetSelectedEntity()
+Handle World::GetHandle(std::uint32_t ref)
 {
-    return GetEntityById(selectedId);
+    return entities.GetHandle(cells.Slot(RefIndex(ref)));
 }
 
-int World::GetNextId()
+void World::SelectEntityByPosition(const Point& worldPosition)
 {
-    if (nextId+1 == std::numeric_limits<int>::max())
-        nextId = 0;
+    const std::uint32_t ref = entitiesTable.Get(worldPosition);
 
-    return ++nextId;
+    selected = Handle();
+    selectedFood = Point(-1,-1);
+    selectedFoodRef = 0;
+
+    if (ref == 0)
+        return;
+
+    if (RefType(ref) == EntityView::TYPE_CELL)
+    {
+        selected = GetHandle(ref);
+    }
+    else
+    {
+        selectedFood = worldPosition;
+        selectedFoodRef = ref & ~foodDeadFlag;
+    }
 }
 
-int World::GetTopId()
+EntityView World::GetSelectedEntity()
 {
-    return nextId;
+    if (selected.IsValid())
+        return GetEntity(selected);
+
+    // the selection is lost when the food died and its field was taken
+    if (IsInside(selectedFood))
+    {
+        const std::uint32_t ref = entitiesTable.Get(selectedFood);
+
+        if ((ref & ~foodDeadFlag) == selectedFoodRef)
+            return EntityView(this, ref, selectedFood);
+    }
+
+    return EntityView();
 }
 
-int World::GetSteps()
+void World::SetSeed(std::uint64_t _seed)
 {
-   return steps;
+    seed = _seed;
+    seedFixed = true;
 }
 
-void World::SetPanelSize(const wxSize& size)
+void World::ResetSeed()
 {
-    panelSize = size;
+    seedFixed = false;
 }
 
-wxPoint World::WorldToPanel(const wxPoint& position)
+std::uint64_t World::GetSeed() const
 {
-    wxRect bbb = GetBoardBoundingBox();
-    wxSize field = GetFieldSize(bbb);
+    return seed;
+}
 
-    return wxPoint(paddingX+field.GetWidth()*position.x, paddingY+field.GetHeight()*position.y);
+bool World::IsSeedFixed() const
+{
+    return seedFixed;
 }
 
-wxPoint World::PanelToWorld(const wxPoint& position)
+std::uint64_t World::GetStateHash()
 {
-    wxRect bbb = GetBoardBoundingBox();
+    std::uint64_t hash = Random::Mix(static_cast<std::uint64_t>(steps));
+
+    auto add = [&hash](std::uint64_t value) {
+        hash = Random::Mix(hash ^ value);
+    };
+
+    add(static_cast<std::uint64_t>(nextId));
 
-    if ( !bbb.Contains(position) )
-        return wxPoint(-1, -1);
+    entitiesTable.ForEach([&add](const Point& p, std::uint32_t ref) {
+        add((static_cast<std::uint64_t>(static_cast<std::uint32_t>(p.y)) << 32) | static_cast<std::uint32_t>(p.x));
+        add(ref);
+    });
 
-    wxSize field = GetFieldSize(bbb);
+    for (std::uint32_t c=0; c<cells.GetQuantity(); c++)
+    {
+        add(static_cast<std::uint32_t>(cells.Id(c)));
+        add(static_cast<std::uint32_t>(cells.Energy(c)));
+        add(static_cast<std::uint32_t>(cells.Age(c)));
+        add(static_cast<std::uint32_t>(cells.LifeTime(c)));
+        add(static_cast<std::uint32_t>(cells.DivEnergy(c)));
+        add(static_cast<std::uint32_t>(cells.Damage(c)));
+        add(static_cast<std::uint32_t>(cells.MutationProbability(c)));
+        add(cells.GeneId(c));
+        add(cells.SpeciesId(c));
+        add(cells.Direction(c));
+        add(cells.Attacked(c));
+    }
+
+    return hash;
+}
+
+int World::GetNextId()
+{
+    if (nextId+1 == std::numeric_limits<int>::max())
+        nextId = 0;
+
+    return ++nextId;
+}
 
-    return wxPoint((position.x-paddingX)/field.GetWidth(), (position.y-paddingY)/field.GetHeight());
+int World::GetTopId()
+{
+    return nextId;
 }
 
-wxSize World::GetFieldSize(const wxRect& board)
+int World::GetSteps()
 {
-    return wxSize(board.GetWidth()/worldSize.GetWidth(), board.GetHeight()/worldSize.GetHeight());
+   return steps;
 }
 
-wxRect World::GetBoardBoundingBox()
+const Size& World::GetSize() const
 {
-    const int padding = 10;
+    return worldSize;
+}
 
-    wxSize tmp = panelSize - wxSize(padding*2,padding*2);
+void World::AddCell(std::uint32_t c, StepContext& context)
+{
+    const std::uint32_t ref = MakeRef(EntityView::TYPE_CELL, c);
 
-    int px = tmp.GetWidth() % worldSize.GetWidth();
-    int py = tmp.GetHeight() % worldSize.GetHeight();
+    cellsCounter++;
+    census[cells.GeneId(c)]++;
+    speciesRegistry.AddMember(cells.SpeciesId(c), cells.Energy(c));
 
-    int w = tmp.GetWidth() - px;
-    int h = tmp.GetHeight() - py;
+    cells.Slot(c) = entities.Insert(ref).index;
+    cellIds.Insert(cells.Id(c), cells.Slot(c));
 
-    paddingX = padding + px/2;
-    paddingY = padding + py/2;
+    entitiesTable.Set(cells.Position(c), ref);
 
-    return wxRect(paddingX, paddingY, w, h);
+    // e.g. a cell with zero lifetime or a child without energy
+    if (cells.IsDead(c))
+        EnqueueDeath(ref, context);
 }
 
-void World::AddEntity(Entity* e)
+void World::AddFood(int type, const Point& position)
 {
-    wxPoint p = e->GetPosition();
+    int lifeTime = params.meatLifeTime;
+    int energy = params.meatEnergy;
 
-    if (e->GetType() == Entity::TYPE_PLANT)
+    if (type == EntityView::TYPE_PLANT)
     {
         plantsCounter++;
+
+        lifeTime = params.plantLifeTime;
+        energy = params.plantEnergy;
     }
     else
     {
-        cellsCounter++;
+        meatCounter++;
     }
 
-    entitiesTable[p.x][p.y] = e;
+    expiryWheel.Schedule(position, lifeTime);
+
+    entitiesTable.Set(position, MakeFood(type, energy, static_cast<std::uint32_t>(expiryWheel.GetNow() + lifeTime)));
 }
 
-bool World::MoveEntity(Entity* e, const wxPoint& newPosition)
+void World::KillEntity(const Point& position, StepContext& context)
 {
-    if (e && LeaseEmptyPoint(newPosition))
-    {
-        wxPoint position = e->GetPosition();
+    const std::uint32_t ref = entitiesTable.Get(position);
 
-        entitiesTable[position.x][position.y] = nullptr;
-        ReleasePoint(position);
+    if (ref == 0 || IsDead(ref))
+        return;
+
+    if (RefType(ref) == EntityView::TYPE_CELL)
+    {
+        const std::uint32_t c = RefIndex(ref);
 
-        e->SetPosition(newPosition);
-        entitiesTable[newPosition.x][newPosition.y] = e;
+        cells.Age(c) = cells.LifeTime(c);
+        EnqueueDeath(ref, context);
 
-        return true;
+        return;
     }
 
-    return false;
+    // the record stays in the field till DeathHandle, like a dead cell
+    entitiesTable.Set(position, ref | foodDeadFlag);
+    context.deadFood.push_back(position);
 }
 
-std::tuple<bool, wxString> World::OpenFromFile(const wxString& filename)
+void World::EnqueueDeath(std::uint32_t ref, StepContext& context)
 {
-    std::ifstream in(filename.c_str().AsChar());
-
-    nlohmann::json config;
+    bool& queued = cells.Queued(RefIndex(ref));
 
-    try
-    {
-        in >> config;
-    }
-    catch (const std::exception& e)
-    {
-        in.close();
-        return { false, wxT("Configuration file is invalid. Please, check its syntax.") };
-    }
+    if (queued)
+        return;
 
-    in.close();
+    queued = true;
+    context.deadCells.push_back(ref);
+}
 
-    int _min = 0;
-    int _max = 0;
+bool World::IsDead(std::uint32_t ref)
+{
+    if (RefType(ref) == EntityView::TYPE_CELL)
+        return cells.IsDead(RefIndex(ref));
 
-    if (!properties->CheckValue(wxString("sortsOfCell"), config["world"]["sortsOfCell"]))
-    {
-        _min = properties->GetMin(wxString("sortsOfCell"));
-        _max = properties->GetMin(wxString("sortsOfCell"));
+    return (ref & foodDeadFlag) != 0;
+}
 
-        return { false, wxString::Format(wxT("Value of 'sortsOfCell' must be between %d and %d."), _min, _max) };
-    }
+int World::GetTimeLeft(std::uint32_t ref)
+{
+    if (ref & foodDeadFlag)
+        return 0;
 
-    if (!properties->CheckValue(wxString("cellEnergy"), config["world"]["cellEnergy"]))
-    {
-        _min = properties->GetMin(wxString("cellEnergy"));
-        _max = properties->GetMin(wxString("cellEnergy"));
+    return static_cast<int>((FoodExpiry(ref) - expiryWheel.GetNow()) & foodExpiryMask);
+}
 
-        return { false, wxString::Format(wxT("Value of 'cellEnergy' must be between %d and %d."), _min, _max) };
-    }
+void World::RemoveCell(std::uint32_t c)
+{
+    const std::uint32_t last = cells.GetQuantity() - 1;
 
-    if (!properties->CheckValue(wxString("maxDamage"), config["world"]["maxDamage"]))
+    if (c != last)
     {
-        _min = properties->GetMin(wxString("maxDamage"));
-        _max = properties->GetMin(wxString("maxDamage"));
+        cells.Copy(last, c);
 
-        return { false, wxString::Format(wxT("Value of 'maxDamage' must be between %d and %d."), _min, _max) };
-    }
+        const std::uint32_t ref = MakeRef(EntityView::TYPE_CELL, c);
 
-    if (!properties->CheckValue(wxString("behaviorGenes"), config["world"]["behaviorGenes"]))
-    {
-        _min = properties->GetMin(wxString("behaviorGenes"));
-        _max = properties->GetMin(wxString("behaviorGenes"));
-
-        return { false, wxString::Format(wxT("Value of 'behaviorGenes' must be between %d and %d."), _min, _max) };
+        entitiesTable.Set(cells.Position(c), ref);
+        *entities.Get(entities.GetHandle(cells.Slot(c))) = ref;
     }
 
-    if (!properties->CheckValue(wxString("minEnergyForDivision"), config["world"]["minEnergyForDivision"]))
-    {
-        _min = properties->GetMin(wxString("minEnergyForDivision"));
-        _max = properties->GetMin(wxString("minEnergyForDivision"));
-
-        return { false, wxString::Format(wxT("Value of 'minEnergyForDivision' must be between %d and %d."), _min, _max) };
-    }
+    cells.PopBack();
+}
 
-    if (!properties->CheckValue(wxString("maxEnergyForDivision"), config["world"]["maxEnergyForDivision"]))
-    {
-        _min = properties->GetMin(wxString("maxEnergyForDivision"));
-        _max = properties->GetMin(wxString("maxEnergyForDivision"));
+void World::CompactCells()
+{
+    const std::uint32_t quantity = cells.GetQuantity();
 
-        return { false, wxString::Format(wxT("Value of 'maxEnergyForDivision' must be between %d and %d."), _min, _max) };
-    }
+    compactionKeys.resize(quantity);
+    compactionScratch.resize(quantity);
+    compactionOrder.resize(quantity);
 
-    if (!properties->CheckValue(wxString("plants"), config["world"]["plants"]))
+    for (std::uint32_t c=0; c<quantity; c++)
     {
-        _min = properties->GetMin(wxString("plants"));
-        _max = properties->GetMin(wxString("plants"));
-
-        return { false, wxString::Format(wxT("Value of 'plants' must be between %d and %d."), _min, _max) };
+        compactionKeys[c] = (static_cast<std::uint64_t>(MortonCode(cells.Position(c))) << 32) | c;
     }
 
-    if (!properties->CheckValue(wxString("plantEnergy"), config["world"]["plantEnergy"]))
-    {
-        _min = properties->GetMin(wxString("plantEnergy"));
-        _max = properties->GetMin(wxString("plantEnergy"));
+    // a radix sort by codes in the upper half of keys, 11 bits a pass
+    const int digitBits = 11;
+    std::array<std::uint32_t, 1 << digitBits> counts;
 
-        return { false, wxString::Format(wxT("Value of 'plantEnergy' must be between %d and %d."), _min, _max) };
-    }
-
-    if (!properties->CheckValue(wxString("meatEnergy"), config["world"]["meatEnergy"]))
+    for (int shift=32; shift<64; shift+=digitBits)
     {
-        _min = properties->GetMin(wxString("meatEnergy"));
-        _max = properties->GetMin(wxString("meatEnergy"));
+        counts.fill(0);
 
-        return { false, wxString::Format(wxT("Value of 'meatEnergy' must be between %d and %d."), _min, _max) };
-    }
+        for (std::uint64_t key: compactionKeys)
+            counts[(key >> shift) & (counts.size() - 1)]++;
 
-    if (!properties->CheckValue(wxString("maxAge"), config["world"]["maxAge"]))
-    {
-        _min = properties->GetMin(wxString("maxAge"));
-        _max = properties->GetMin(wxString("maxAge"));
+        std::uint32_t offset = 0;
 
-        return { false, wxString::Format(wxT("Value of 'maxAge' must be between %d and %d."), _min, _max) };
-    }
+        for (std::uint32_t& count: counts)
+        {
+            const std::uint32_t n = count;
+            count = offset;
+            offset += n;
+        }
 
-    if (!properties->CheckValue(wxString("stepsPerSecond"), config["world"]["stepsPerSecond"]))
-    {
-        _min = properties->GetMin(wxString("stepsPerSecond"));
-        _max = properties->GetMin(wxString("stepsPerSecond"));
+        for (std::uint64_t key: compactionKeys)
+            compactionScratch[counts[(key >> shift) & (counts.size() - 1)]++] = key;
 
-        return { false, wxString::Format(wxT("Value of 'stepsPerSecond' must be between %d and %d."), _min, _max) };
+        compactionKeys.swap(compactionScratch);
     }
 
-    if (!properties->CheckValue(wxString("plantsPerStep"), config["world"]["plantsPerStep"]))
+    for (std::uint32_t i=0; i<quantity; i++)
     {
-        _min = properties->GetMin(wxString("plantsPerStep"));
-        _max = properties->GetMin(wxString("plantsPerStep"));
-
-        return { false, wxString::Format(wxT("Value of 'plantsPerStep' must be between %d and %d."), _min, _max) };
+        compactionOrder[i] = static_cast<std::uint32_t>(compactionKeys[i]);
     }
 
-    if (!properties->CheckValue(wxString("worldWidth"), config["world"]["worldWidth"]))
-    {
-        _min = properties->GetMin(wxString("worldWidth"));
-        _max = properties->GetMin(wxString("worldWidth"));
-
-        return { false, wxString::Format(wxT("Value of 'worldWidth' must be between %d and %d."), _min, _max) };
-    }
+    cells.Permute(compactionOrder, compactionBlocks);
 
-    if (!properties->CheckValue(wxString("worldHeight"), config["world"]["worldHeight"]))
+    for (std::uint32_t c=0; c<quantity; c++)
     {
-        _min = properties->GetMin(wxString("worldHeight"));
-        _max = properties->GetMin(wxString("worldHeight"));
+        const std::uint32_t ref = MakeRef(EntityView::TYPE_CELL, c);
 
-        return { false, wxString::Format(wxT("Value of 'worldHeight' must be between %d and %d."), _min, _max) };
+        entitiesTable.Set(cells.Position(c), ref);
+        *entities.Get(entities.GetHandle(cells.Slot(c))) = ref;
     }
+}
 
-    if (!properties->CheckValue(wxString("plantLifeTime"), config["world"]["plantLifeTime"]))
-    {
-        _min = properties->GetMin(wxString("plantLifeTime"));
-        _max = properties->GetMin(wxString("plantLifeTime"));
-
-        return { false, wxString::Format(wxT("Value of 'plantLifeTime' must be between %d and %d."), _min, _max) };
-    }
+bool World::MoveCell(std::uint32_t c, const Point& newPosition, StepContext& context)
+{
+    if (!IsInside(newPosition) || entitiesTable.Get(newPosition) != 0)
+        return false;
 
-    if (!properties->CheckValue(wxString("meatLifeTime"), config["world"]["meatLifeTime"]))
-    {
-        _min = properties->GetMin(wxString("meatLifeTime"));
-        _max = properties->GetMin(wxString("meatLifeTime"));
+    Point& position = cells.Position(c);
 
-        return { false, wxString::Format(wxT("Value of 'meatLifeTime' must be between %d and %d."), _min, _max) };
-    }
+    entitiesTable.Set(position, 0);
+    context.fields.push_back(position);
+    context.fields.push_back(newPosition);
 
-    if (!properties->CheckValue(wxString("movementEnergy"), config["world"]["movementEnergy"]))
-    {
-        _min = properties->GetMin(wxString("movementEnergy"));
-        _max = properties->GetMin(wxString("movementEnergy"));
+    position = newPosition;
+    entitiesTable.Set(newPosition, MakeRef(EntityView::TYPE_CELL, c));
 
-        return { false, wxString::Format(wxT("Value of 'movementEnergy' must be between %d and %d."), _min, _max) };
-    }
+    return true;
+}
 
-    if (!properties->CheckValue(wxString("attackEnergy"), config["world"]["attackEnergy"]))
-    {
-        _min = properties->GetMin(wxString("attackEnergy"));
-        _max = properties->GetMin(wxString("attackEnergy"));
+std::tuple<bool, std::string> World::OpenFromFile(const std::string& filename)
+{
+    std::ifstream in(filename);
 
-        return { false, wxString::Format(wxT("Value of 'attackEnergy' must be between %d and %d."), _min, _max) };
-    }
+    nlohmann::json config;
 
-    if (!properties->CheckValue(wxString("attackCondition"), config["world"]["attackCondition"]))
+    try
     {
-        _min = properties->GetMin(wxString("attackCondition"));
-        _max = properties->GetMin(wxString("attackCondition"));
-
-        return { false, wxString::Format(wxT("Value of 'attackCondition' must be between %d and %d."), _min, _max) };
+        in >> config;
     }
-
-    if (!properties->CheckValue(wxString("maxMutationProbability"), config["world"]["maxMutationProbability"]))
+    catch (const std::exception& e)
     {
-        _min = properties->GetMin(wxString("maxMutationProbability"));
-        _max = properties->GetMin(wxString("maxMutationProbability"));
-
-        return { false, wxString::Format(wxT("Value of 'maxMutationProbability' must be between %d and %d."), _min, _max) };
+        in.close();
+        return { false, "Configuration file is invalid. Please, check its syntax." };
     }
 
-    properties->SetValue(wxString("sortsOfCell"), config["world"]["sortsOfCell"]);
-    properties->SetValue(wxString("cellEnergy"), config["world"]["cellEnergy"]);
-    properties->SetValue(wxString("maxDamage"), config["world"]["maxDamage"]);
-    properties->SetValue(wxString("behaviorGenes"), config["world"]["behaviorGenes"]);
-    properties->SetValue(wxString("minEnergyForDivision"), config["world"]["minEnergyForDivision"]);
-    properties->SetValue(wxString("maxEnergyForDivision"), config["world"]["maxEnergyForDivision"]);
-    properties->SetValue(wxString("plants"), config["world"]["plants"]);
-    properties->SetValue(wxString("plantEnergy"), config["world"]["plantEnergy"]);
-    properties->SetValue(wxString("meatEnergy"), config["world"]["meatEnergy"]);
-    properties->SetValue(wxString("maxAge"), config["world"]["maxAge"]);
-    properties->SetValue(wxString("stepsPerSecond"), config["world"]["stepsPerSecond"]);
-    properties->SetValue(wxString("plantsPerStep"), config["world"]["plantsPerStep"]);
-    properties->SetValue(wxString("worldWidth"), config["world"]["worldWidth"]);
-    properties->SetValue(wxString("worldHeight"), config["world"]["worldHeight"]);
-    properties->SetValue(wxString("plantLifeTime"), config["world"]["plantLifeTime"]);
-    properties->SetValue(wxString("meatLifeTime"), config["world"]["meatLifeTime"]);
-    properties->SetValue(wxString("movementEnergy"), config["world"]["movementEnergy"]);
-    properties->SetValue(wxString("attackEnergy"), config["world"]["attackEnergy"]);
-    properties->SetValue(wxString("attackCondition"), config["world"]["attackCondition"]);
-    properties->SetValue(wxString("maxMutationProbability"), config["world"]["maxMutationProbability"]);
+    in.close();
 
-    return { true, wxT("") };
-}
+    const nlohmann::json& section = config["world"];
 
-bool World::SaveToFile(const wxString& filename)
-{
-    nlohmann::json config;
+    if (!section.is_object())
+        return { false, "Configuration file hasn't the 'world' section." };
 
-    config["world"]["sortsOfCell"] = properties->GetValue(wxString("sortsOfCell"));
-    config["world"]["cellEnergy"] = properties->GetValue(wxString("cellEnergy"));
-    config["world"]["maxDamage"] = properties->GetValue(wxString("maxDamage"));
-    config["world"]["behaviorGenes"] = properties->GetValue(wxString("behaviorGenes"));
-    config["world"]["minEnergyForDivision"] = properties->GetValue(wxString("minEnergyForDivision"));
-    config["world"]["maxEnergyForDivision"] = properties->GetValue(wxString("maxEnergyForDivision"));
-    config["world"]["plants"] = properties->GetValue(wxString("plants"));
-    config["world"]["plantEnergy"] = properties->GetValue(wxString("plantEnergy"));
-    config["world"]["meatEnergy"] = properties->GetValue(wxString("meatEnergy"));
-    config["world"]["maxAge"] = properties->GetValue(wxString("maxAge"));
-    config["world"]["stepsPerSecond"] = properties->GetValue(wxString("stepsPerSecond"));
-    config["world"]["plantsPerStep"] = properties->GetValue(wxString("plantsPerStep"));
-    config["world"]["worldWidth"] = properties->GetValue(wxString("worldWidth"));
-    config["world"]["worldHeight"] = properties->GetValue(wxString("worldHeight"));
-    config["world"]["plantLifeTime"] = properties->GetValue(wxString("plantLifeTime"));
-    config["world"]["meatLifeTime"] = properties->GetValue(wxString("meatLifeTime"));
-    config["world"]["movementEnergy"] = properties->GetValue(wxString("movementEnergy"));
-    config["world"]["attackEnergy"] = properties->GetValue(wxString("attackEnergy"));
-    config["world"]["attackCondition"] = properties->GetValue(wxString("attackCondition"));
-    config["world"]["maxMutationProbability"] = properties->GetValue(wxString("maxMutationProbability"));
-
-    std::ofstream out(filename.c_str().AsChar());
+    // all values are checked before any of them is changed
+    for (const SimParams::Field& field: SimParams::GetFields())
+    {
+        auto it = section.find(field.name);
 
-    out << std::setw(4) << config << std::endl;
-    out.close();
+        if (it == section.end())
+        {
+            if (field.optional)
+                continue;
 
-    return true;
-}
+            return { false, "Value of '" + std::string(field.name) + "' is missing." };
+        }
 
+        if (!it->is_number_integer() || !properties->CheckValue(field.name, it->get<int>()))
+        {
+            const int _min = properties->GetMin(field.name);
+            const int _max = properties->GetMax(field.name);
 
-void World::DrawBoard(wxDC* dc)
-{
-    wxRect bbb = GetBoardBoundingBox();
-    wxSize field = GetFieldSize(bbb);
+            return { false, "Value of '" + std::string(field.name) + "' must be between " + std::to_string(_min) + " and " + std::to_string(_max) + "." };
+        }
+    }
 
-    // draw border
-    dc->SetPen( wxPen( wxColor(0,0,0), 2 ) );
-    dc->DrawRectangle( bbb );
+    // the seed is optional, without it a world is random
+    auto seedIt = section.find("seed");
 
-    // draw vertical lines
-    dc->SetPen( wxPen( wxColor(0,0,0), 1 ) );
+    if (seedIt != section.end() && !seedIt->is_number_unsigned())
+        return { false, "Value of 'seed' must be a non-negative integer." };
 
-    for (int i=bbb.GetX()+field.GetWidth(); i<(bbb.GetX()+bbb.GetWidth()); i+=field.GetWidth())
+    for (const SimParams::Field& field: SimParams::GetFields())
     {
-        dc->DrawLine( i, bbb.GetY(), i, bbb.GetY()+bbb.GetHeight() );
+        auto it = section.find(field.name);
+
+        if (it != section.end())
+            properties->SetValue(field.name, it->get<int>());
     }
 
-    // draw horizontal lines
-    for (int i=bbb.GetY()+field.GetHeight(); i<(bbb.GetY()+bbb.GetHeight()); i+=field.GetHeight())
+    if (seedIt != section.end())
     {
-        dc->DrawLine( bbb.GetX(), i, bbb.GetX()+bbb.GetWidth(), i );
+        SetSeed(seedIt->get<std::uint64_t>());
     }
-}
-
-void World::DrawEntities(wxDC* dc)
-{
-    for (int i=0; i<worldSize.GetWidth(); i++)
+    else
     {
-        for (int j=0; j<worldSize.GetHeight(); j++)
-        {
-            if (entitiesTable[i][j])
-                entitiesTable[i][j]->Draw(dc);
-        }
+        ResetSeed();
     }
 
-    Entity* se = GetSelectedEntity();
-
-    if (se)
-        se->DrawSelected(dc);
+    return { true, "" };
 }
 
-void World::GenerateEmptyPoints()
+bool World::SaveToFile(const std::string& filename)
 {
-    emptyPoints.clear();
+    nlohmann::json config;
 
-    for (int i=0; i<worldSize.GetWidth(); i++)
+    for (const SimParams::Field& field: SimParams::GetFields())
     {
-        for (int j=0; j<worldSize.GetHeight(); j++)
-        {
-            wxPoint p(i,j);
-
-            if (nullptr == GetEntityByPosition(p))
-            {
-                emptyPoints.push_back(p);
-            }
-        }
+        config["world"][field.name] = properties->GetValue(field.name);
     }
-}
 
-bool World::LeaseEmptyPoint(const wxPoint& point)
-{
-    auto it (std::find(emptyPoints.begin(), emptyPoints.end(), point));
+    // a fixed seed makes the same world again from the file, a random one
+    // isn't saved, so the file stays random too
+    if (seedFixed)
+        config["world"]["seed"] = seed;
 
-    if (it != emptyPoints.end())
-    {
-        *it = std::move(emptyPoints.back());
-        emptyPoints.pop_back();
-
-        //wxLogMessage(wxString::Format(wxT("Point (%i,%i) has been leased."), point.x, point.y));
+    std::ofstream out(filename);
 
-        return true;
-    }
-
-    //wxLogMessage(wxString::Format(wxT("Try to lease point (%d,%d), but fail."), point.x, point.y));
+    out << std::setw(4) << config << std::endl;
+    out.close();
 
-    return false;
+    return true;
 }
 
-wxPoint World::LeaseRandomEmptyPoint()
+
+void World::GenerateEmptyPoints()
 {
-    wxPoint point(-1,-1);
+    emptyPoints.Reset(worldSize.GetWidth(), worldSize.GetHeight());
 
-    if (emptyPoints.size()>0)
-    {
-        auto index = effolkronium::random_static::get<int>(0, emptyPoints.size()-1);
-        point = emptyPoints[index];
+    entitiesTable.ForEach([this](const Point& p, std::uint32_t) {
+        emptyPoints.Lease(p);
+    });
+}
 
-        emptyPoints[index] = std::move(emptyPoints.back());
-        emptyPoints.pop_back();
-    }
-    else
-    {
-        //wxLogMessage(wxString::Format(wxT("The world hasn't empty points.")));
-    }
-
-    //wxLogMessage(wxString::Format(wxT("Lease random point (%d,%d)."), point.x, point.y));
+bool World::LeaseEmptyPoint(const Point& point)
+{
+    return emptyPoints.Lease(point);
+}
 
-    return point;
+Point World::LeaseRandomEmptyPoint(Random& random)
+{
+    return emptyPoints.LeaseRandom(random);
 }
 
-void World::ReleasePoint(const wxPoint& point)
+void World::ReleasePoint(const Point& point)
 {
-    emptyPoints.push_back(point);
-
-    //wxLogMessage(wxString::Format(wxT("Release point (%d,%d)."), point.x, point.y));
+    emptyPoints.Release(point);
 }
 
-void World::GenerateEntities(int type, int quantity)
+void World::GenerateEntities(int type, int quantity, Random& random)
 {
     for (int i=0; i<quantity; i++)
     {
-        wxPoint point = LeaseRandomEmptyPoint();
+        Point point = LeaseRandomEmptyPoint(random);
 
-        if (point == wxPoint(-1,-1))
+        if (point == Point(-1,-1))
             break;
 
-        Entity* tmp = nullptr;
-
         switch (type)
         {
-        case Entity::TYPE_PLANT:
-            {
-                Plant* plt = (Plant*)_allocator.Allocate(sizeof(Plant), _alignment);
-                if (plt)
-                {
-                    new(plt) Plant(this);
-                    tmp = plt;
-                }
-            }
+        case EntityView::TYPE_PLANT:
+            AddFood(EntityView::TYPE_PLANT, point);
             break;
-        case Entity::TYPE_CELL:
+        case EntityView::TYPE_CELL:
             {
-                Cell* cl = (Cell*)_allocator.Allocate(sizeof(Cell), _alignment);
-                if (cl)
+                std::uint32_t c = 0;
+
+                if (!cells.Add(c))
                 {
-                    new(cl) Cell(this, wxString::Format(wxT("gene%d"), i+1));
-                    tmp = cl;
+                    ReleasePoint(point);
+                    Logger::Message("World::GenerateEntities (Critical): can't allocate memory.");
+                    break;
                 }
+
+                geneNames.push_back("gene" + std::to_string(i+1));
+
+                cells.Id(c) = GetNextId();
+                cells.Position(c) = point;
+
+                cells.LifeTime(c) = random.Get(0, params.maxAge);
+                cells.Energy(c) = params.cellEnergy;
+                cells.DivEnergy(c) = random.Get(params.minEnergyForDivision, params.maxEnergyForDivision);
+                cells.Damage(c) = random.Get(0, params.maxDamage);
+                cells.MutationProbability(c) = random.Get(0, params.maxMutationProbability);
+
+                cells.Direction(c) = GenerateDirection(random);
+
+                cells.GeneId(c) = GenerateGene(random);
+                cells.SpeciesId(c) = FoundSpecies(GenerateColor(random), static_cast<std::uint16_t>(geneNames.size() - 1), Species::noParent, LineageRecord::noLocus);
+
+                if (cellLineageEnabled)
+                    cells.Lineage(c) = cellLineage.Add(LineageTree::noNode, static_cast<std::uint32_t>(cells.Id(c)), steps, LineageRecord::noLocus);
+
+                AddCell(c, stepContext);
             }
             break;
         default:
+            ReleasePoint(point);
             break;
         }
+    }
+}
 
-        if (tmp)
+void World::DeathHandle()
+{
+    for (const Point& p: deadFood)
+    {
+        if (RefType(entitiesTable.Get(p)) == EntityView::TYPE_PLANT)
         {
-            tmp->SetPosition(point);
-            AddEntity(tmp);
+            plantsCounter--;
         }
         else
         {
-            ReleasePoint(point);
-            wxLogMessage(wxT("World::GenerateEntities (Critical): can't allocate memory."));
+            meatCounter--;
         }
-    }
-}
 
-void World::DeathHandle()
-{
-    /*
-    auto iter = entitiesList.begin();
+        entitiesTable.Set(p, 0);
+        ReleasePoint(p);
+    }
 
-    while (iter != entitiesList.end())
-    {
-        Entity* e = *iter;
+    deadFood.clear();
 
-        if ( e && e->IsDead() )
-        {
-            if ( e->GetType() == Entity::TYPE_PLANT || e->GetType() == Entity::TYPE_MEAT )
-            {
-                switch (e->GetType())
-                {
-                case Entity::TYPE_PLANT:
-                    plantsCounter--;
-                    break;
-                case Entity::TYPE_MEAT:
-                    meatCounter--;
-                    break;
-                default:
-                    break;
-                }
+    // Cells are removed from the last one: the cell which RemoveCell moves
+    // into the place of a dead one is alive, so a dead cell is never copied
+    // and indices of the rest of the dead ones stay the same
+    std::sort(deadCells.begin(), deadCells.end(), std::greater<std::uint32_t>());
 
-                wxPoint p = e->GetPosition();
-                entitiesTable[p.x][p.y] = nullptr;
+    for (std::uint32_t c: deadCells)
+    {
+        const Point p = cells.Position(c);
 
-                ReleasePoint(p);
-                delete e;
-                entitiesList.erase(iter++);  // alternatively, iter = entities.erase(iter);
-            }
-            else if ( e->GetType() == Entity::TYPE_CELL )
-            {
-                wxPoint p = e->GetPosition();
-                delete e;
+        cellsCounter--;
+        census[cells.GeneId(c)]--;
+        const std::uint32_t speciesLineageNode = speciesRegistry.Get(cells.SpeciesId(c)).lineage;
 
-                e = new Meat(this);
-                e->SetPosition(p);
+        if (speciesRegistry.RemoveMember(cells.SpeciesId(c), cells.Energy(c)))
+            speciesLineage.Release(speciesLineageNode);
 
-                entitiesTable[p.x][p.y] = e;
+        cellLineage.Release(cells.Lineage(c));
 
-                *iter = e;
+        cellIds.Remove(cells.Id(c));
+        entities.Remove(entities.GetHandle(cells.Slot(c)));
+        RemoveCell(c);
 
-                cellsCounter--;
-                meatCounter++;
-            }
-        }
-        else
-        {
-            ++iter;
-        }
+        // a dead cell turns into meat on the same field: the reference of the
+        // cell is overwritten by a record of meat, the field stays taken and
+        // nothing is allocated or freed except the last block of the store
+        AddFood(EntityView::TYPE_MEAT, p);
     }
-    */
-
-    for (int i=0; i<worldSize.GetWidth(); i++)
-    {
-        for (int j=0; j<worldSize.GetHeight(); j++)
-        {
-            Entity* e = entitiesTable[i][j];
 
-            if ( e && e->IsDead() )
-            {
-                if ( e->GetType() == Entity::TYPE_PLANT || e->GetType() == Entity::TYPE_MEAT )
-                {
-                    wxPoint p = e->GetPosition();
-
-                    entitiesTable[p.x][p.y] = nullptr;
-                    ReleasePoint(p);
-
-                    if (e->GetType() == Entity::TYPE_PLANT)
-                    {
-                        plantsCounter--;
-                    }
-                    else
-                    {
-                        meatCounter--;
-                    }
-
-                    {
-                        e->~Entity();
-                        _allocator.Free(reinterpret_cast<void*>(e));
-                    }
-                }
-                else if ( e->GetType() == Entity::TYPE_CELL )
-                {
-                    wxPoint p = e->GetPosition();
-
-                    {
-                        e->~Entity();
-                        _allocator.Free(reinterpret_cast<void*>(e));
-                    }
-
-                    entitiesTable[p.x][p.y] = nullptr;
-                    e = nullptr;
-
-                    cellsCounter--;
-
-                    {
-                        Meat* mt = (Meat*)_allocator.Allocate(sizeof(Meat), _alignment);
-                        if (mt)
-                        {
-                            new(mt) Meat(this);
-                            e = mt;
-                        }
-                        else
-                        {
-                            wxLogMessage(wxT("World::DeathHandle (Critical): can't allocate memory."));
-                        }
-                    }
-
-                    if (e)
-                    {
-                        e->SetPosition(p);
-                        entitiesTable[p.x][p.y] = e;
-                        meatCounter++;
-                    }
-                    else
-                    {
-                        ReleasePoint(p);
-                    }
-                }
-            }
-        }
-    }
+    deadCells.clear();
 }
 
 void World::ClearEntitiesTable()
 {
-    for (int i=0; i<worldSize.GetWidth(); i++)
-        for (int j=0; j<worldSize.GetHeight(); j++)
-        {
-            if (entitiesTable[i][j])
-            {
-                {
-                    Entity* e = entitiesTable[i][j];
-                    e->~Entity();
-                    _allocator.Free(e);
-                }
+    cells.Clear();
+    geneNames.clear();
+    speciesRegistry.Clear();
 
-                entitiesTable[i][j] = nullptr;
-            }
-        }
+    speciesLineage.Clear();
+    cellLineage.Clear();
+    census.assign(Genotype::quantity, 0);
+
+    deadCells.clear();
+    deadFood.clear();
+
+    for (StepContext& context: contexts)
+        context.Clear();
+
+    stepContext.Clear();
+
+    entities.Clear();
+    cellIds.Clear();
+    expiryWheel.Reset();
+
+    entitiesTable.Reset(worldSize.GetWidth(), worldSize.GetHeight());
 }
 
 void World::ClearEmptyPoints()
 {
-    emptyPoints.clear();
+    emptyPoints.Clear();
 }
 
 std::tuple<int, int, int> World::GetEntitiesQuantity()
@@ -819,468 +1236,399 @@ std::tuple<int, int, int> World::GetEntitiesQuantity()
     return { plantsCounter, meatCounter, cellsCounter };
 }
 
-std::tuple<std::size_t, std::size_t, std::size_t> World::GetMemoryInfo()
+const std::vector<int>& World::GetCensus() const
 {
-    return { _allocator.GetTotal(), _allocator.GetUsed(), _allocator.GetPeak() };
+    return census;
 }
 
-// ENTITY CLASS
-Entity::Entity(World* _world): world(_world)
+void World::SetLineageOptions(const std::string& logFile, bool trackCells, std::size_t budget)
 {
-    id = world->GetNextId();
+    lineageLogFile = logFile;
+    lineageCellsOption = trackCells;
+    lineageBudgetOption = budget;
 }
 
-Entity::~Entity() {}
-
-void Entity::Step()
+bool World::GetAncestry(const Handle& cell, bool byCells, std::vector<LineageRecord>& ancestry)
 {
-    if (IsDead()) return;
-    age++;
-}
+    ancestry.clear();
 
-bool Entity::IsDead()
-{
-    return (age >= lifeTime) || (energy <= 0);
-}
+    const std::uint32_t* ref = entities.Get(cell);
 
-void Entity::Die() { age = lifeTime; }
-int Entity::GetId() { return id; }
+    if (ref == nullptr)
+        return false;
 
-void Entity::SetColor(const wxColor& _color) { color = _color; }
-const wxColor& Entity::GetColor() const { return color; }
+    const std::uint32_t c = RefIndex(*ref);
 
-void Entity::SetPosition(const wxPoint& _position) { position = _position; }
-const wxPoint& Entity::GetPosition() const { return position; }
+    if (byCells)
+    {
+        if (!cellLineageEnabled)
+            return false;
 
-int Entity::GetType() { return type; }
+        cellLineage.GetAncestry(cells.Lineage(c), ancestry);
+    }
+    else
+    {
+        speciesLineage.GetAncestry(speciesRegistry.Get(cells.SpeciesId(c)).lineage, ancestry);
+    }
 
-void Entity::SetEnergy(int _energy) { energy = _energy; }
-int Entity::GetEnergy() { return energy; }
+    return true;
+}
 
-wxString Entity::Get(const wxString& name)
+std::tuple<std::size_t, std::size_t, std::uint64_t> World::GetLineageInfo()
 {
-    if (name == wxString("id"))
-        return wxString::Format(wxT("%d"), id);
-    if (name == wxString("age"))
-        return wxString::Format(wxT("%d"), age);
-    if (name == wxString("maxAge"))
-        return wxString::Format(wxT("%d"), lifeTime);
-    if (name == wxString("energy"))
-        return wxString::Format(wxT("%d"), energy);
-
-    return unknownValueStr;
+    return { speciesLineage.GetQuantity(), cellLineage.GetQuantity(), lineageLog.GetRecords() };
 }
 
-void Entity::SetSelectedBrushAndPen(wxDC* dc)
+const SpeciesRegistry& World::GetSpecies() const
 {
-    wxBrush brush;
-    wxPen pen;
-
-    brush.SetStyle(wxBRUSHSTYLE_CROSSDIAG_HATCH);
-    brush.SetColour(wxColor(255,255,255));
-
-    pen.SetColour(color);
-    pen.SetWidth(2);
-
-    dc->SetBrush(brush);
-    dc->SetPen(pen);
+    return speciesRegistry;
 }
 
-void Entity::SetNormalBrushAndPen(wxDC* dc)
+int World::GetGenotypeCount(std::uint16_t genotype) const
 {
-    wxBrush brush;
-    wxPen pen;
-
-    brush.SetStyle(wxBRUSHSTYLE_SOLID);
-    brush.SetColour(color);
+    if (genotype >= census.size())
+        return 0;
 
-    pen.SetColour(color);
-
-    dc->SetBrush(brush);
-    dc->SetPen(pen);
+    return census[genotype];
 }
 
-void Entity::DrawCircle(wxDC* dc)
+std::tuple<std::size_t, std::size_t, std::size_t> World::GetMemoryInfo()
 {
-    wxRect bbb = world->GetBoardBoundingBox();
-    wxSize field = world->GetFieldSize(bbb);
+    if (!_allocator)
+        return { 0, 0, 0 };
 
-    int radius = field.GetHeight()/3;
-
-    wxPoint p = world->WorldToPanel(position);
-    dc->DrawCircle(p.x+field.GetWidth()/2, p.y+field.GetHeight()/2, radius);
+    return { _allocator->GetTotal(), _allocator->GetUsed(), _allocator->GetPeak() };
 }
 
-void Entity::DrawRectangle(wxDC* dc)
+std::tuple<std::size_t, std::size_t> World::GetMemoryPages()
 {
-    wxRect bbb = world->GetBoardBoundingBox();
-    wxSize field = world->GetFieldSize(bbb);
-
-    int w = int(field.GetWidth()*0.8f);
-    int h = int(field.GetHeight()*0.8f);
+    if (!_allocator)
+        return { 0, 0 };
 
-    wxPoint p = world->WorldToPanel(position);
-
-    p.x += field.GetWidth()/2 - w/2;
-    p.y += field.GetHeight()/2 - h/2;
-
-    dc->DrawRectangle(p.x, p.y, w, h);
+    return { _allocator->GetTotal(), _allocator->GetReserved() };
 }
 
-// PLANT CLASS
-
-Plant::Plant(World* _world): Entity(_world)
+mtrebi::Allocator::Statistics World::GetMemoryStatistics()
 {
-    type = Entity::TYPE_PLANT;
-    color = wxColor(43,168,74);
-    lifeTime = world->GetProperties()->GetValue(wxString("plantLifeTime"));
-}
+    if (!_allocator)
+        return mtrebi::Allocator::Statistics();
 
-Plant::~Plant() {}
-
-void Plant::Draw(wxDC* dc)
-{
-    SetNormalBrushAndPen(dc);
-    DrawCircle(dc);
+    return _allocator->GetStatistics();
 }
 
-void Plant::DrawSelected(wxDC* dc)
+bool World::SaveMemoryStatistics(const std::string& filename)
 {
-    SetSelectedBrushAndPen(dc);
-    DrawCircle(dc);
-}
-
-// MEAT CLASS
+    auto [total, used, peak] = GetMemoryInfo();
+    auto [resident, reserved] = GetMemoryPages();
+    const mtrebi::Allocator::Statistics statistics = GetMemoryStatistics();
 
-Meat::Meat(World* _world): Entity(_world) {
-    type = Entity::TYPE_MEAT;
-    color = wxColor(205,83,59);
-    lifeTime = world->GetProperties()->GetValue(wxString("meatLifeTime"));
-}
+    nlohmann::json dump;
 
-Meat::~Meat() {}
+    dump["step"] = steps;
+    dump["total"] = total;
+    dump["used"] = used;
+    dump["peak"] = peak;
+    dump["resident"] = resident;
+    dump["reserved"] = reserved;
+    dump["allocations"] = statistics.allocations;
+    dump["frees"] = statistics.frees;
+    dump["failures"] = statistics.failures;
+    dump["freeBlocks"] = statistics.freeBlocks;
+    dump["freeSize"] = statistics.freeSize;
+    dump["largestFreeBlock"] = statistics.largestFreeBlock;
+    dump["fragmentation"] = statistics.GetFragmentation();
 
-void Meat::Draw(wxDC* dc)
-{
-    SetNormalBrushAndPen(dc);
-    DrawCircle(dc);
-}
+    // walks by powers of two, see mtrebi::Allocator::Statistics
+    dump["allocateWalks"] = std::vector<std::size_t>(std::begin(statistics.allocateWalks), std::end(statistics.allocateWalks));
+    dump["freeWalks"] = std::vector<std::size_t>(std::begin(statistics.freeWalks), std::end(statistics.freeWalks));
 
-void Meat::DrawSelected(wxDC* dc)
-{
-    SetSelectedBrushAndPen(dc);
-    DrawCircle(dc);
-}
+    std::ofstream out(filename);
 
-// CELL CLASS
+    if (!out)
+        return false;
 
-// sets of behavior
-static const std::array<int, 4> emptyActions { Gene::ACTION_TURN_L, Gene::ACTION_TURN_R, Gene::ACTION_MOVE, Gene::ACTION_NONE };
-static const std::array<int, 3> otherActions { Gene::ACTION_TURN_L, Gene::ACTION_TURN_R, Gene::ACTION_ATTACK };
-static const std::array<int, 3> sameActions { Gene::ACTION_TURN_L, Gene::ACTION_TURN_R, Gene::ACTION_ATTACK };
-static const std::array<int, 4> meatActions { Gene::ACTION_TURN_L, Gene::ACTION_TURN_R, Gene::ACTION_NONE, Gene::ACTION_EAT };
-static const std::array<int, 4> plantActions { Gene::ACTION_TURN_L, Gene::ACTION_TURN_R, Gene::ACTION_NONE, Gene::ACTION_EAT };
-static const std::array<int, 2> wallActions { Gene::ACTION_TURN_L, Gene::ACTION_TURN_R };
-static const std::array<int, 2> weakActions { Gene::ACTION_TURN_L, Gene::ACTION_TURN_R };
-static const std::array<int, 3> deadActions { Gene::ACTION_TURN_L, Gene::ACTION_TURN_R, Gene::ACTION_NONE };
+    out << std::setw(4) << dump << std::endl;
+    out.close();
 
-Cell::Cell(World* _world, const wxString& geneName): Entity(_world)
-{
-    type = Entity::TYPE_CELL;
+    return true;
+}
 
-    lifeTime = effolkronium::random_static::get<int>(
-        0,
-        world->GetProperties()->GetValue(wxString("maxAge"))
-    );
+// CELLS
 
-    energy = world->GetProperties()->GetValue(wxString("cellEnergy"));
+void World::StepCell(std::uint32_t c, StepContext& context)
+{
+    if (cells.IsDead(c))
+    {
+        return;
+    }
 
-    divEnergy = effolkronium::random_static::get<int>(
-        world->GetProperties()->GetValue(wxString("minEnergyForDivision")),
-        world->GetProperties()->GetValue(wxString("maxEnergyForDivision"))
-    );
+    cells.Age(c)++;
 
-    damage = effolkronium::random_static::get<int>(
-        0,
-        world->GetProperties()->GetValue(wxString("maxDamage"))
-    );
+    Behave(c, context);
 
-    mutationProbability = effolkronium::random_static::get<int>(
-        0,
-        world->GetProperties()->GetValue(wxString("maxMutationProbability"))
-    );
+    // energy and age of a cell change only during its own step or an attack
+    if (cells.IsDead(c))
+        EnqueueDeath(MakeRef(EntityView::TYPE_CELL, c), context);
+}
 
-    direction = GenerateDirection();
+void World::Behave(std::uint32_t c, StepContext& context)
+{
+    if (cells.Attacked(c))
+    {
+        cells.LastBehavior(c) = CellStore::BEHAVIOR_ATTACKED;
+        cells.Attacked(c) = false;
+    }
+    else if (CanDivide(c))
+    {
+        cells.LastBehavior(c) = CellStore::BEHAVIOR_DIVISION;
+        Clone(c, context);
+    }
+    else // genetic behavior
+    {
+        std::uint32_t ref = 0;
+        const int situation = Perceive(c, ref);
 
-    gen1 = GenerateGene(geneName);
-    color = GenerateColor();
+        Execute(c, Genotype::Decode(cells.GeneId(c))[situation], context);
+    }
 }
 
-Cell::Cell(World* _world, int _divEnergy, int _damage, int _mutationProbability, const wxColor& _color, const Gene& _gene): Entity(_world)
+// returns the situation in front of a cell and the reference in that field,
+// the situation is kept as the last behavior
+int World::Perceive(std::uint32_t c, std::uint32_t& ref)
 {
-    type = Entity::TYPE_CELL;
+    const Point p = cells.Position(c) + _directions[cells.Direction(c)];
 
-    divEnergy = _divEnergy;
-    damage = _damage;
-    mutationProbability = _mutationProbability;
-    energy = 0;
+    if (!IsInside(p))
+    {
+        ref = 0;
+        cells.LastBehavior(c) = CellStore::BEHAVIOR_WALL;
 
-    lifeTime = effolkronium::random_static::get<int>(1, world->GetProperties()->GetValue(wxString("maxAge")));
+        return Gene::SITUATION_WALL;
+    }
 
-    direction = GenerateDirection();
+    int situation = Gene::SITUATION_EMPTY;
+    std::uint8_t behavior = CellStore::BEHAVIOR_EMPTY;
 
-    auto mutation = effolkronium::random_static::get<bool>(mutationProbability/100.f);
+    ref = entitiesTable.Get(p);
 
-    if (mutation)
+    if (ref == 0)
+    {
+        situation = Gene::SITUATION_EMPTY;
+        behavior = CellStore::BEHAVIOR_EMPTY;
+    }
+    else if (IsDead(ref))
     {
-        gen1 = MutateGene(_gene);
-        color = GenerateColor();
+        situation = Gene::SITUATION_DEAD;
+        behavior = CellStore::BEHAVIOR_DEAD;
+    }
+    else if (RefType(ref) == EntityView::TYPE_PLANT)
+    {
+        situation = Gene::SITUATION_PLANT;
+        behavior = CellStore::BEHAVIOR_PLANT;
+    }
+    else if (RefType(ref) == EntityView::TYPE_MEAT)
+    {
+        situation = Gene::SITUATION_MEAT;
+        behavior = CellStore::BEHAVIOR_MEAT;
+    }
+    else if (cells.SpeciesId(RefIndex(ref)) == cells.SpeciesId(c))
+    {
+        situation = Gene::SITUATION_SAME;
+        behavior = CellStore::BEHAVIOR_SAME;
     }
     else
     {
-        gen1 = _gene;
-        color = _color;
+        situation = Gene::SITUATION_OTHER;
+        behavior = CellStore::BEHAVIOR_OTHER;
     }
-}
-
-Cell::~Cell() {}
 
-wxPoint Cell::GenerateDirection()
-{
-    static const std::array<wxPoint,8> directions {
-        wxPoint(1,0),
-        wxPoint(1,1),
-        wxPoint(0,1),
-        wxPoint(-1,1),
-        wxPoint(-1,0),
-        wxPoint(-1,-1),
-        wxPoint(0,-1),
-        wxPoint(1,-1)
-    };
+    cells.LastBehavior(c) = behavior;
 
-    return directions[effolkronium::random_static::get<int>(0, directions.size()-1)];
+    return situation;
 }
 
-void Cell::Step()
+// like StepCell and Behave, but nothing which is seen by other cells is
+// changed, so cells may be sensed at once; the age grows when cells act
+World::Intent World::Sense(std::uint32_t c)
 {
-    if (IsDead())
-    {
-        return;
-    }
-
-    age++;
+    Intent intent;
 
-    if (attacked)
+    if (cells.IsDead(c))
     {
-        SetLastBehavior(wxT("attacked"));
-        attacked = false;
+        intent.action = Intent::skip;
+        return intent;
     }
-    else if (CanDivide())
+
+    if (cells.Attacked(c))
     {
-        SetLastBehavior(wxT("division"));
-        Clone();
+        cells.LastBehavior(c) = CellStore::BEHAVIOR_ATTACKED;
+        cells.Attacked(c) = false;
+
+        return intent;
     }
-    else // genetic behavior
+
+    if (CanDivide(c))
     {
-        wxPoint p = position + direction;
+        cells.LastBehavior(c) = CellStore::BEHAVIOR_DIVISION;
+        intent.action = Intent::divide;
 
-        if (!world->IsInside(p))
-        {
-            SetLastBehavior(wxT("wall"));
-            Execute(gen1.wall);
-            return;
-        }
+        return intent;
+    }
 
-        Entity* e = world->GetEntityByPosition(p);
+    std::uint32_t ref = 0;
+    const int situation = Perceive(c, ref);
+    const Gene::Code& gene = Genotype::Decode(cells.GeneId(c));
 
-        if (e == nullptr)
-        {
-            SetLastBehavior(wxT("empty"));
-            Execute(gen1.empty);
-            return;
-        }
+    intent.action = gene[situation];
 
-        if (e->IsDead())
-        {
-            SetLastBehavior(wxT("dead"));
-            Execute(gen1.dead);
-            return;
-        }
+    if (intent.action == Gene::ACTION_ATTACK)
+    {
+        intent.victim = RefIndex(ref);
 
-        switch (e->GetType())
+        if (!CanAttack(c, intent.victim))
         {
-        case TYPE_PLANT:
-            SetLastBehavior(wxT("plant"));
-            Execute(gen1.plant);
-            break;
-        case TYPE_MEAT:
-            SetLastBehavior(wxT("meat"));
-            Execute(gen1.meat);
-            break;
-        case TYPE_CELL:
-            if (e->GetColor() == color)
-            {
-                SetLastBehavior(wxT("same cell"));
-                Execute(gen1.same);
-            }
-            else {
-                SetLastBehavior(wxT("other cell"));
-                Execute(gen1.other);
-            }
-            break;
-        default:
-            break;
+            cells.LastBehavior(c) = CellStore::BEHAVIOR_WEAK;
+            intent.action = gene[Gene::SITUATION_WEAK];
         }
     }
-}
-
-void Cell::Draw(wxDC* dc)
-{
-    SetNormalBrushAndPen(dc);
 
-    DrawRectangle(dc);
-    DrawDirection(dc);
+    return intent;
 }
 
-void Cell::DrawSelected(wxDC* dc)
+// every change of energy of a live cell goes here, so totals of species stay
+// up to date
+void World::AddEnergy(std::uint32_t c, int delta, StepContext& context)
 {
-    SetSelectedBrushAndPen(dc);
-    DrawRectangle(dc);
+    cells.Energy(c) += delta;
+    context.energy.emplace_back(cells.SpeciesId(c), delta);
 }
 
-void Cell::DrawDirection(wxDC* dc)
+bool World::Attack(std::uint32_t c, std::uint32_t victim, StepContext& context)
 {
-    wxRect bbb = world->GetBoardBoundingBox();
-    wxSize field = world->GetFieldSize(bbb);
-
-    wxPoint a = world->WorldToPanel(position);
-
-    a.x += field.GetWidth() / 2;
-    a.y += field.GetHeight() / 2;
-
-    wxPoint b(a.x+direction.x*field.GetWidth(), a.y+direction.y*field.GetHeight());
-
-    dc->DrawLine(a, b);
-}
-
-bool Cell::Attack(Cell* victim)
-{
-    if (energy - victim->GetEnergy() < world->GetProperties()->GetValue(wxString("attackCondition")) )
+    if (!CanAttack(c, victim))
         return false;
 
-    victim->SetEnergy(victim->GetEnergy() - damage);
-    victim->SetAttacked(true);
+    Hit(c, victim, context);
 
     return true;
 }
 
-void Cell::SetAttacked(bool _attacked)
+bool World::CanAttack(std::uint32_t c, std::uint32_t victim)
 {
-    attacked = _attacked;
+    return cells.Energy(c) - cells.Energy(victim) >= params.attackCondition;
 }
 
-const Gene& Cell::GetGene()
+void World::Hit(std::uint32_t c, std::uint32_t victim, StepContext& context)
 {
-    return gen1;
-}
+    AddEnergy(victim, -cells.Damage(c), context);
+    cells.Attacked(victim) = true;
 
-void Cell::SetGene(const Gene& _gene)
-{
-    gen1 = _gene;
+    if (cells.IsDead(victim))
+        EnqueueDeath(MakeRef(EntityView::TYPE_CELL, victim), context);
 }
 
-
-void Cell::Clone()
+// The child takes a row of the room of the context and the field of its
+// parent; it gets an id, a new species and a slot when it is born, see
+// BearChildren. Till then it has the species of the parent.
+void World::Clone(std::uint32_t c, StepContext& context)
 {
-    wxPoint oldPosition = position;
-    wxPoint newPosition = position + direction;
+    const Point oldPosition = cells.Position(c);
+    const Point newPosition = oldPosition + _directions[cells.Direction(c)];
+
+    // there is no room only if there wasn't memory for it
+    if (context.roomNext == context.roomEnd)
+        return;
 
-    Entity* child = nullptr;
+    if (!MoveCell(c, newPosition, context))
     {
-        Cell* cl = (Cell*)_allocator.Allocate(sizeof(Cell), _alignment);
-        if (cl)
-        {
-            new(cl) Cell(world, divEnergy, damage, mutationProbability, color, gen1);
-            child = cl;
-        }
-        else
-        {
-            wxLogMessage(wxT("Cell::Clone (Critical): can't allocate memory."));
-            return;
-        }
+        assert(!"Cell::Clone (Logical): can't move a parent cell to new position.");
+        return;
     }
 
-    if (world->MoveEntity(this, newPosition))
+    const std::uint32_t child = context.roomNext++;
+
+    cells.Place(child);
+
+    const int energy = (cells.Energy(c) - params.movementEnergy) / 2;
+
+    AddEnergy(c, energy - cells.Energy(c), context);
+
+    cells.Position(child) = oldPosition;
+    cells.Energy(child) = energy;
+
+    cells.DivEnergy(child) = cells.DivEnergy(c);
+    cells.Damage(child) = cells.Damage(c);
+    cells.MutationProbability(child) = cells.MutationProbability(c);
+
+    // draws of a birth are keyed by the parent, it divides once a step
+    Random random(seed, static_cast<std::uint64_t>(steps), static_cast<std::uint32_t>(cells.Id(c)), RANDOM_BIRTH);
+
+    cells.LifeTime(child) = random.Get(1, params.maxAge);
+    cells.Direction(child) = GenerateDirection(random);
+
+    auto mutation = random.Chance(cells.MutationProbability(c)/100.f);
+
+    Birth& birth = births[child - birthsFirst];
+
+    birth.parent = c;
+    birth.energy = energy;
+    birth.locus = LineageRecord::noLocus;
+
+    if (mutation)
     {
-        if (world->LeaseEmptyPoint(oldPosition))
-        {
-            energy = (energy - world->GetProperties()->GetValue(wxString("movementEnergy"))) / 2;
+        int locus = LineageRecord::noLocus;
 
-            child->SetPosition(oldPosition);
-            child->SetEnergy(energy);
+        cells.GeneId(child) = MutateGene(cells.GeneId(c), locus, random);
 
-            world->AddEntity(child);
-            childrenCounter++;
-        }
-        else
-        {
-            wxASSERT_MSG(0, wxT("Cell::Clone (Logical): can't lease an empty point for a child."));
-        }
+        birth.color = GenerateColor(random);
+        birth.locus = static_cast<std::uint8_t>(locus);
     }
     else
     {
-        wxASSERT_MSG(0, wxT("Cell::Clone (Logical): can't move a parent cell to new position."));
+        cells.GeneId(child) = cells.GeneId(c);
     }
-}
 
-int Cell::NormalizeCoord(int x)
-{
-    if (x > 0) return 1;
-    if (x < 0) return -1;
+    cells.SpeciesId(child) = cells.SpeciesId(c);
 
-    return 0;
-}
+    const std::uint32_t ref = MakeRef(EntityView::TYPE_CELL, child);
 
-void Cell::SetLastBehavior(const wxString& behavior)
-{
-    lastBehavior = behavior;
+    entitiesTable.Set(oldPosition, ref);
+
+    if (cells.IsDead(child))
+        EnqueueDeath(ref, context);
+
+    cells.ChildrenCounter(c)++;
 }
 
-void Cell::Execute(int cmd)
+void World::Execute(std::uint32_t c, int cmd, StepContext& context)
 {
     if (cmd == Gene::ACTION_TURN_L)
     {
-        int x = direction.x + direction.y;
-        int y = direction.y - direction.x;
+        std::uint8_t& direction = cells.Direction(c);
 
-        direction.x = NormalizeCoord(x);
-        direction.y = NormalizeCoord(y);
-
-        energy -= world->GetProperties()->GetValue(wxString("movementEnergy"));
+        direction = (direction + 7) & 7;
+        AddEnergy(c, -params.movementEnergy, context);
 
         return;
     }
 
     if (cmd == Gene::ACTION_TURN_R)
     {
-        int x = direction.x - direction.y;
-        int y = direction.x + direction.y;
-
-        direction.x = NormalizeCoord(x);
-        direction.y = NormalizeCoord(y);
+        std::uint8_t& direction = cells.Direction(c);
 
-        energy -= world->GetProperties()->GetValue(wxString("movementEnergy"));
+        direction = (direction + 1) & 7;
+        AddEnergy(c, -params.movementEnergy, context);
 
         return;
     }
 
     if (cmd == Gene::ACTION_MOVE)
     {
-        wxPoint p = position + direction;
+        const Point p = cells.Position(c) + _directions[cells.Direction(c)];
 
-        if (world->MoveEntity(this, p))
+        if (MoveCell(c, p, context))
         {
-            energy -= world->GetProperties()->GetValue(wxString("movementEnergy"));
+            AddEnergy(c, -params.movementEnergy, context);
         }
 
         return;
@@ -1293,24 +1641,24 @@ void Cell::Execute(int cmd)
 
     if (cmd == Gene::ACTION_ATTACK)
     {
-        wxPoint p = position + direction;
-        Entity* e = world->GetEntityByPosition(p);
+        const Point p = cells.Position(c) + _directions[cells.Direction(c)];
+        const std::uint32_t ref = IsInside(p) ? entitiesTable.Get(p) : 0;
 
-        if (e && e->GetType() == TYPE_CELL)
+        if (ref && RefType(ref) == EntityView::TYPE_CELL)
         {
-            Cell* c = dynamic_cast<Cell*>(e);
+            const std::uint32_t victim = RefIndex(ref);
 
-            if (!Attack(c))
+            if (!Attack(c, victim, context))
             {
-                SetLastBehavior(wxT("weak"));
-                Execute(gen1.weak);
+                cells.LastBehavior(c) = CellStore::BEHAVIOR_WEAK;
+                Execute(c, Genotype::Decode(cells.GeneId(c))[Gene::SITUATION_WEAK], context);
             }
             else
             {
-                energy -= world->GetProperties()->GetValue(wxString("attackEnergy"));
+                AddEnergy(c, -params.attackEnergy, context);
 
-                if (c->IsDead())
-                    killsCounter++;
+                if (cells.IsDead(victim))
+                    cells.KillsCounter(c)++;
             }
         }
 
@@ -1319,139 +1667,88 @@ void Cell::Execute(int cmd)
 
     if (cmd == Gene::ACTION_EAT)
     {
-        wxPoint p = position + direction;
-        Entity* e = world->GetEntityByPosition(p);
+        const Point p = cells.Position(c) + _directions[cells.Direction(c)];
+        const std::uint32_t ref = IsInside(p) ? entitiesTable.Get(p) : 0;
 
-        if (e)
+        if (ref)
         {
-            switch(e->GetType())
+            switch (RefType(ref))
             {
-            case TYPE_PLANT:
-                energy += world->GetProperties()->GetValue(wxString("plantEnergy"));
-                eatenPlantsCounter++;
+            case EntityView::TYPE_PLANT:
+                AddEnergy(c, FoodEnergy(ref), context);
+                cells.EatenPlantsCounter(c)++;
                 break;
-            case TYPE_MEAT:
-                energy += world->GetProperties()->GetValue(wxString("meatEnergy"));
-                eatenMeatCounter++;
+            case EntityView::TYPE_MEAT:
+                AddEnergy(c, FoodEnergy(ref), context);
+                cells.EatenMeatCounter(c)++;
                 break;
             default:
                 break;
             }
 
-            e->Die();
+            KillEntity(p, context);
         }
     }
 }
 
-Gene Cell::GenerateGene(const wxString& name)
+std::uint16_t World::GenerateGene(Random& random)
 {
-    Gene newGene(name);
+    std::uint16_t genotype = 0;
 
-    newGene.empty = emptyActions[effolkronium::random_static::get<int>(0, emptyActions.size()-1)];
-    newGene.other = otherActions[effolkronium::random_static::get<int>(0, otherActions.size()-1)];
-    newGene.same = sameActions[effolkronium::random_static::get<int>(0, sameActions.size()-1)];
-    newGene.meat = meatActions[effolkronium::random_static::get<int>(0, meatActions.size()-1)];
-    newGene.plant = plantActions[effolkronium::random_static::get<int>(0, plantActions.size()-1)];
-    newGene.wall = wallActions[effolkronium::random_static::get<int>(0, wallActions.size()-1)];
-    newGene.weak = weakActions[effolkronium::random_static::get<int>(0, weakActions.size()-1)];
-    newGene.dead = deadActions[effolkronium::random_static::get<int>(0, deadActions.size()-1)];
+    for (int situation=0; situation<Gene::SITUATION_QUANTITY; situation++)
+    {
+        genotype = Genotype::SetDigit(genotype, situation, random.Get(0, Genotype::GetRadix(situation)-1));
+    }
 
-    return newGene;
+    return genotype;
 }
 
-Gene Cell::MutateGene(const Gene& _gene)
+std::uint16_t World::MutateGene(std::uint16_t genotype, int& locus, Random& random)
 {
-    Gene newGene = _gene;
+    locus = random.Get(Gene::SITUATION_EMPTY, Gene::SITUATION_DEAD);
 
-    enum
-    {
-        EMPTY = 0,
-        OTHER,
-        SAME,
-        MEAT,
-        PLANT,
-        WALL,
-        WEAK,
-        DEAD
-    };
+    return Genotype::SetDigit(genotype, locus, random.Get(0, Genotype::GetRadix(locus)-1));
+}
+
+std::uint32_t World::FoundSpecies(const Color& color, std::uint16_t geneName, std::uint32_t parent, std::uint8_t locus)
+{
+    std::uint32_t parentNode = LineageTree::noNode;
+    std::uint32_t parentSerial = Species::noParent;
 
-    switch (effolkronium::random_static::get<int>(EMPTY, DEAD))
+    if (parent != Species::noParent)
     {
-    case EMPTY:
-        newGene.empty = emptyActions[effolkronium::random_static::get<int>(0, emptyActions.size()-1)];
-        break;
-    case OTHER:
-        newGene.other = otherActions[effolkronium::random_static::get<int>(0, otherActions.size()-1)];
-        break;
-    case SAME:
-        newGene.same = sameActions[effolkronium::random_static::get<int>(0, sameActions.size()-1)];
-        break;
-    case MEAT:
-        newGene.meat = meatActions[effolkronium::random_static::get<int>(0, meatActions.size()-1)];
-        break;
-    case PLANT:
-        newGene.plant = plantActions[effolkronium::random_static::get<int>(0, plantActions.size()-1)];
-        break;
-    case WALL:
-        newGene.wall = wallActions[effolkronium::random_static::get<int>(0, wallActions.size()-1)];
-        break;
-    case WEAK:
-        newGene.weak = weakActions[effolkronium::random_static::get<int>(0, weakActions.size()-1)];
-        break;
-    case DEAD:
-        newGene.dead = deadActions[effolkronium::random_static::get<int>(0, deadActions.size()-1)];
-        break;
-    default:
-        break;
+        parentNode = speciesRegistry.Get(parent).lineage;
+        parentSerial = speciesRegistry.Get(parent).serial;
     }
 
-    return newGene;
+    const std::uint32_t id = speciesRegistry.Found(color, geneName, steps, parent);
+    const std::uint32_t serial = speciesRegistry.Get(id).serial;
+
+    speciesRegistry.SetLineage(id, speciesLineage.Add(parentNode, serial, steps, locus));
+    lineageLog.Append(serial, parentSerial, steps, locus);
+
+    return id;
 }
 
-wxColor Cell::GenerateColor()
+Color World::GenerateColor(Random& random)
 {
-    int r = effolkronium::random_static::get<int>(0, 128);
-    int g = effolkronium::random_static::get<int>(0, 128);
-    int b = effolkronium::random_static::get<int>(0, 128);
+    int r = random.Get(0, 128);
+    int g = random.Get(0, 128);
+    int b = random.Get(0, 128);
 
-    return wxColor(r,g,b);
+    return Color(r,g,b);
 }
 
-bool Cell::CanDivide()
+std::uint8_t World::GenerateDirection(Random& random)
 {
-    wxPoint p = position;
-    p += direction;
-    return ( (energy >= divEnergy) && world->IsInside(p) && (world->GetEntityByPosition(p) == nullptr) );
+    return static_cast<std::uint8_t>(random.Get(0, static_cast<int>(_directions.size())-1));
 }
 
-wxString Cell::Get(const wxString& name)
+bool World::CanDivide(std::uint32_t c)
 {
-    if (name == wxString("id"))
-        return wxString::Format(wxT("%d"), id);
-    if (name == wxString("age"))
-        return wxString::Format(wxT("%d"), age);
-    if (name == wxString("maxAge"))
-        return wxString::Format(wxT("%d"), lifeTime);
-    if (name == wxString("energy"))
-        return wxString::Format(wxT("%d"), energy);
-    if (name == wxString("divEnergy"))
-        return wxString::Format(wxT("%d"), divEnergy);
-    if (name == wxString("mutation"))
-        return wxString::Format(wxT("%d"), mutationProbability);
-    if (name == wxString("damage"))
-        return wxString::Format(wxT("%d"), damage);
-    if (name == wxString("kills"))
-        return wxString::Format(wxT("%d"), killsCounter);
-    if (name == wxString("childrens"))
-        return wxString::Format(wxT("%d"), childrenCounter);
-    if (name == wxString("eatenPlants"))
-        return wxString::Format(wxT("%d"), eatenPlantsCounter);
-    if (name == wxString("eatenMeat"))
-        return wxString::Format(wxT("%d"), eatenMeatCounter);
-    if (name == wxString("lastBehavior"))
-        return lastBehavior;
+    const Point p = cells.Position(c) + _directions[cells.Direction(c)];
 
-    return unknownValueStr;
+    return ( (cells.Energy(c) >= cells.DivEnergy(c)) && IsInside(p) && (entitiesTable.Get(p) == 0) );
 }
 
 }
@@ -9,17 +9,27 @@
 #ifndef _ENTITIES_H_
 #define _ENTITIES_H_
 
-#include "wx/wxprec.h"
-
-#ifndef WX_PRECOMP
-#include <wx/wx.h>
-#endif
-
 #include <vector>
 #include <tuple>
+#include <string>
+#include <utility>
+#include <cstdint>
 
+#include "types.h"
+#include "grid.h"
+#include "emptypoints.h"
 #include "gene.h"
+#include "genotype.h"
+#include "species.h"
+#include "lineage.h"
 #include "properties.h"
+#include "simparams.h"
+#include "scheduler.h"
+#include "timingwheel.h"
+#include "slotmap.h"
+#include "idindex.h"
+#include "cellstore.h"
+#include "workerpool.h"
 #include "constants.h"
 #include "random.h"
 #include "config.h"
@@ -27,229 +37,432 @@
 namespace ProtoPuddle
 {
 
-class Entity;
+class World;
+
+// A thin view of an entity for the GUI and tools. It refers to the current
+// place of the entity in the world, so it is valid until the next step; use a
+// handle to follow a cell for longer.
+class EntityView
+{
+public:
+    // types for entities
+    enum
+    {
+        TYPE_PLANT = 1,
+        TYPE_MEAT,
+        TYPE_CELL,
+        TYPE_WALL
+    };
+
+    EntityView() {}
+    EntityView(World* _world, std::uint32_t _ref, const Point& _position): world(_world), ref(_ref), position(_position) {}
+
+    explicit operator bool() const { return ref != 0; }
+
+    int GetType() const;
+    int GetId() const;
+
+    Color GetColor() const;
+    Point GetPosition() const;
+
+    // cells only, plants and meat have neither ids nor handles
+    Point GetDirection() const;
+    Gene GetGene() const;
+
+    Handle GetHandle() const;
+
+    std::string Get(const std::string& name) const;
+
+private:
+    World* world {nullptr};
+    std::uint32_t ref {0};
+    Point position {Point(-1,-1)};
+};
 
 class World
 {
 public:
-    World(wxFrame* _parentFrame, GlobalProperties* _properties);
+    explicit World(GlobalProperties* _properties);
     ~World();
 
     void Step();
-    void Draw(wxDC* dc);
+
+    // Cells act in parallel if there are several threads: the grid is split
+    // into tiles of 16x16 fields and tiles of one of four colours act at once
+    // (see Scheduler::Partition), in the synchronous order threads sense.
+    // Cells are stepped by tiles for one thread too and the records of tiles
+    // are merged in the order of tiles, so results are the same for any
+    // quantity of threads. One thread by default; it takes effect from the
+    // next step.
+    void SetThreads(int threads);
+    int GetThreads() const;
 
     void SetProperties(GlobalProperties* _properties);
     GlobalProperties* GetProperties();
 
-    Entity* GetEntityByPosition(const wxPoint& worldPosition);
-    Entity* GetEntityById(int id);
+    // compiles the properties into the parameters of the simulation, it must be
+    // called after the properties were changed outside of the world
+    void ApplyProperties();
+    const SimParams& GetParams() const;
 
-    int GetEntityIdByPosition(const wxPoint& worldPosition);
+    EntityView GetEntityByPosition(const Point& worldPosition);
+    EntityView GetEntityById(int id);
 
-    void SelectEntityByPosition(const wxPoint& worldPosition);
-    Entity* GetSelectedEntity();
+    // O(1), returns an empty view if the cell has died; unlike an id, a
+    // handle is the way to follow a cell from step to step
+    EntityView GetEntity(const Handle& handle);
+
+    int GetEntityIdByPosition(const Point& worldPosition);
+
+    void SelectEntityByPosition(const Point& worldPosition);
+    EntityView GetSelectedEntity();
 
     // returns plants, meat, cells
     std::tuple<int, int, int> GetEntitiesQuantity();
 
-    // returns total, used, peak
+    // quantities of cells by genotypes (see genotype.h), they are kept up
+    // to date on births and deaths, dead cells are counted till the end of
+    // the step like in GetEntitiesQuantity
+    const std::vector<int>& GetCensus() const;
+    int GetGenotypeCount(std::uint16_t genotype) const;
+
+    // populations and energy of species are kept up to date like the census
+    const SpeciesRegistry& GetSpecies() const;
+
+    // The descent of species is always kept, the descent of cells on demand.
+    // Branching events of species are written to the log if a file is given.
+    // Each tree keeps extinct ancestors up to its budget of nodes, then it is
+    // compacted. The options take effect in New().
+    void SetLineageOptions(const std::string& logFile, bool trackCells, std::size_t budget = LineageTree::defaultBudget);
+
+    // the ancestry of a living cell by species or by cells, from the cell to
+    // the oldest kept ancestor; returns false if the cell has died or its
+    // cells aren't tracked
+    bool GetAncestry(const Handle& cell, bool byCells, std::vector<LineageRecord>& ancestry);
+
+    // returns nodes of species, nodes of cells, records in the log
+    std::tuple<std::size_t, std::size_t, std::uint64_t> GetLineageInfo();
+
+    // returns total, used, peak; the total is the size of mapped pages of
+    // blocks of cells
     std::tuple<std::size_t, std::size_t, std::size_t> GetMemoryInfo();
 
-    bool IsInside(const wxPoint& worldPosition);
+    // returns resident (mapped) and reserved bytes, the reserved size is the
+    // limit of the pages for the area of the world
+    std::tuple<std::size_t, std::size_t> GetMemoryPages();
+
+    // counters of the allocator of blocks of cells since New() and its free
+    // blocks, SaveMemoryStatistics writes them with the memory info as JSON
+    mtrebi::Allocator::Statistics GetMemoryStatistics();
+    bool SaveMemoryStatistics(const std::string& filename);
+
+    bool IsInside(const Point& worldPosition);
+
+    // All random draws of a world are keyed by its seed (see random.h): a
+    // world made by New() with the same seed and properties goes through the
+    // same steps. The seed is fixed by SetSeed or by the "seed" value of a
+    // configuration, otherwise New() takes a new one from the clock. The seed
+    // of the current world is saved with the configuration.
+    void SetSeed(std::uint64_t _seed);
+    void ResetSeed();
+    std::uint64_t GetSeed() const;
+    bool IsSeedFixed() const;
+
+    // a hash of the step, the grid and all attributes of cells; worlds which
+    // went the same way have equal hashes
+    std::uint64_t GetStateHash();
 
     int GetNextId();
     int GetTopId();
     int GetSteps();
 
-    void New();
-
-    void SetPanelSize(const wxSize& size);
+    const Size& GetSize() const;
 
-    wxPoint WorldToPanel(const wxPoint& position);
-    wxPoint PanelToWorld(const wxPoint& position);
-    wxSize GetFieldSize(const wxRect& board);
-    wxRect GetBoardBoundingBox();
-
-    void AddEntity(Entity* e);
-    bool MoveEntity(Entity* e, const wxPoint& newPosition);
+    // Pools and buffers of a step survive New() and grow to the largest world
+    // they have seen, so a step allocates only when the world becomes larger
+    // than it has ever been since the World was created.
+    void New();
 
-    std::tuple<bool, wxString> OpenFromFile(const wxString& filename);
-    bool SaveToFile(const wxString& filename);
+    std::tuple<bool, std::string> OpenFromFile(const std::string& filename);
+    bool SaveToFile(const std::string& filename);
 
-    bool LeaseEmptyPoint(const wxPoint& point);
-    wxPoint LeaseRandomEmptyPoint();
-    void ReleasePoint(const wxPoint& point);
+    bool LeaseEmptyPoint(const Point& point);
+    Point LeaseRandomEmptyPoint(Random& random);
+    void ReleasePoint(const Point& point);
 
 private:
-    void StepEntities();
+    friend class EntityView;
+
+    // A field of the grid keeps the type of an entity in the upper two bits,
+    // zero is an empty field. For a cell the rest is its index in the store
+    // of cells, the same reference is kept in the table of handles.
+    static const int refShift {30};
+    static const std::uint32_t refMask {(std::uint32_t(1) << refShift) - 1};
+
+    static std::uint32_t MakeRef(int type, std::uint32_t index) { return (std::uint32_t(type) << refShift) | index; }
+    static int RefType(std::uint32_t ref) { return static_cast<int>(ref >> refShift); }
+    static std::uint32_t RefIndex(std::uint32_t ref) { return ref & refMask; }
+
+    // Plants and meat live in the field itself: a flag of death, energy (up to
+    // 500, see properties.h) and the step of expiry modulo 2^20 (lifetimes are
+    // up to 1000 steps) follow the type.
+    static const int foodEnergyShift {20};
+    static const std::uint32_t foodExpiryMask {(std::uint32_t(1) << foodEnergyShift) - 1};
+    static const std::uint32_t foodEnergyMask {(std::uint32_t(1) << 9) - 1};
+    static const std::uint32_t foodDeadFlag {std::uint32_t(1) << 29};
+
+    static std::uint32_t MakeFood(int type, int energy, std::uint32_t expiry)
+    {
+        return MakeRef(type, ((std::uint32_t(energy) & foodEnergyMask) << foodEnergyShift) | (expiry & foodExpiryMask));
+    }
 
-    void DrawBoard(wxDC* dc);
-    void DrawEntities(wxDC* dc);
+    static int FoodEnergy(std::uint32_t ref) { return static_cast<int>((ref >> foodEnergyShift) & foodEnergyMask); }
+    static std::uint32_t FoodExpiry(std::uint32_t ref) { return ref & foodExpiryMask; }
 
-    void GenerateEmptyPoints();
+    // sizes of the records of a context, a tile owns the records between the
+    // sizes before and after it was run
+    struct Marks
+    {
+        std::size_t deadCells {0};
+        std::size_t deadFood {0};
+        std::size_t fields {0};
+        std::size_t energy {0};
+    };
 
-    void GenerateEntities(int type, int quantity);
+    // Effects of cells on shared state. A worker collects them for its tiles,
+    // they are merged in the order of tiles into the context of the step and
+    // applied after all cells acted.
+    struct StepContext
+    {
+        // references of dead cells and positions of eaten food
+        std::vector<std::uint32_t> deadCells;
+        std::vector<Point> deadFood;
+
+        // fields which were taken or freed, the set of empty points follows
+        // them; a field is empty iff it is zero in the grid
+        std::vector<Point> fields;
+
+        // changes of energy of species
+        std::vector<std::pair<std::uint32_t, int>> energy;
+
+        // rows of the store which are free for children of the current tile
+        std::uint32_t roomNext {0};
+        std::uint32_t roomEnd {0};
+
+        Marks Mark() const
+        {
+            return { deadCells.size(), deadFood.size(), fields.size(), energy.size() };
+        }
+
+        void Clear()
+        {
+            deadCells.clear();
+            deadFood.clear();
+            fields.clear();
+            energy.clear();
+        }
+    };
 
-    void DeathHandle();
+    // a decision of a cell in the synchronous order: an action of its gene
+    // or a division, an attack keeps its victim; dead cells are skipped
+    struct Intent
+    {
+        static const std::uint8_t divide {0xff};
+        static const std::uint8_t skip {0xfe};
 
-    void ClearEntitiesTable();
-    void ClearEmptyPoints();
+        std::uint32_t victim {0};
+        std::uint8_t action {Gene::ACTION_NONE};
+    };
 
-private:
-    std::vector<wxPoint> emptyPoints;
+    // a cell which wants to take a field (by a move or a division) or to eat
+    // a food in it
+    struct Contender
+    {
+        std::uint64_t field {0};
+        std::uint32_t priority {0};
+        std::uint32_t cell {0};
+    };
 
-    int nextId {0};
-    int selectedId {-1};
-    int steps {0};
+    // A child waits in a row of the room till the end of its phase: the
+    // energy it got from the parent and its mutation are kept here, the row
+    // it takes in the store is known when it is born.
+    struct Birth
+    {
+        std::uint32_t parent {0};
+        std::uint32_t row {0};
+        int energy {0};
+        Color color;
+        std::uint8_t locus {LineageRecord::noLocus};
+    };
 
-    int plantsCounter {0};
-    int meatCounter {0};
-    int cellsCounter {0};
+    struct TileRun
+    {
+        int worker {0};
 
-    int paddingX {0};
-    int paddingY {0};
+        std::uint32_t room {0};
+        std::uint32_t roomNext {0};
+        std::uint32_t roomEnd {0};
 
-    GlobalProperties* properties {nullptr};
+        Marks first;
+        Marks last;
+    };
 
-    wxSize worldSize {wxSize(0,0)};
-    wxSize panelSize {wxSize(0,0)};
+    static const int tileShift {4};
 
-    wxFrame* parentFrame {nullptr};
-};
+    // domains of random streams, a stream is keyed by a domain, a step and
+    // an entity
+    enum
+    {
+        RANDOM_NEW = 1,
+        RANDOM_PLANTS,
+        RANDOM_BIRTH,
+        RANDOM_ORDER
+    };
 
-class Entity
-{
-public:
-    Entity(World* _world);
+    void StepEntities();
+    void StepTiles();
+    void StepSynchronous();
+    void ApplyContext();
 
-    virtual ~Entity();
+    // children of the rows [first, last) of the room get ids, species and
+    // slots and are appended to the store in the order of rows
+    void BearChildren(std::uint32_t first, std::uint32_t last, StepContext& context);
 
-    virtual void Step();
-    virtual void Draw(wxDC* dc) = 0;
-    virtual void DrawSelected(wxDC* dc) = 0;
+    // appends records of a tile to the context of the step
+    void MergeRecords(const TileRun& run);
 
-    bool IsDead();
+    void GenerateEmptyPoints();
 
-    void Die();
+    void GenerateEntities(int type, int quantity, Random& random);
 
-    int GetId();
+    // registers a new cell in the grid and in the table of handles
+    void AddCell(std::uint32_t c, StepContext& context);
 
-    void SetColor(const wxColor& _color);
-    const wxColor& GetColor() const;
+    void AddFood(int type, const Point& position);
 
-    void SetPosition(const wxPoint& _position);
-    const wxPoint& GetPosition() const;
+    // entities must die through the world, so every dead entity gets into
+    // a queue once
+    void KillEntity(const Point& position, StepContext& context);
+    void EnqueueDeath(std::uint32_t ref, StepContext& context);
 
-    int GetType();
+    bool IsDead(std::uint32_t ref);
+    Handle GetHandle(std::uint32_t ref);
 
-    void SetEnergy(int _energy);
-    int GetEnergy();
+    // the remaining time of a plant or meat
+    int GetTimeLeft(std::uint32_t ref);
 
-    virtual wxString Get(const wxString& name);
+    void DeathHandle();
 
-    // types for entities
-    enum
-    {
-        TYPE_PLANT = 1,
-        TYPE_MEAT,
-        TYPE_CELL,
-        TYPE_WALL
-    };
+    // removes a cell from the store, the last one takes its index
+    void RemoveCell(std::uint32_t c);
 
-protected:
-    void SetSelectedBrushAndPen(wxDC* dc);
-    void SetNormalBrushAndPen(wxDC* dc);
-    void DrawCircle(wxDC* dc);
-    void DrawRectangle(wxDC* dc);
+    // Cells are reordered by the Z-order of their fields every
+    // compactionInterval steps: neighbours in the world become neighbours in
+    // the store, references in the grid and in the slot map are fixed
+    void CompactCells();
 
-protected:
-    int type {0};
-    int id {-1};
-    int age {0};
-    int lifeTime {0};
-    int energy {1};
+    void ClearEntitiesTable();
+    void ClearEmptyPoints();
 
-    World* world {nullptr};
+    // behavior of cells
+    void StepCell(std::uint32_t c, StepContext& context);
+    void Behave(std::uint32_t c, StepContext& context);
+    int Perceive(std::uint32_t c, std::uint32_t& ref);
+    Intent Sense(std::uint32_t c);
+    void Execute(std::uint32_t c, int cmd, StepContext& context);
+    void Clone(std::uint32_t c, StepContext& context);
+    bool Attack(std::uint32_t c, std::uint32_t victim, StepContext& context);
+    bool CanAttack(std::uint32_t c, std::uint32_t victim);
+    void Hit(std::uint32_t c, std::uint32_t victim, StepContext& context);
+    void AddEnergy(std::uint32_t c, int delta, StepContext& context);
+    bool MoveCell(std::uint32_t c, const Point& newPosition, StepContext& context);
+    bool CanDivide(std::uint32_t c);
 
-    wxColor color {wxColor(0,0,0)};
-    wxPoint position {wxPoint(-1,-1)};
-};
+    std::uint16_t GenerateGene(Random& random);
+    std::uint16_t MutateGene(std::uint16_t genotype, int& locus, Random& random);
 
-class Plant: public Entity
-{
-public:
-    Plant(World* _world);
-    virtual ~Plant();
+    std::uint32_t FoundSpecies(const Color& color, std::uint16_t geneName, std::uint32_t parent, std::uint8_t locus);
 
-    void Draw(wxDC* dc) final;
-    void DrawSelected(wxDC* dc) final;
-};
+    Color GenerateColor(Random& random);
+    std::uint8_t GenerateDirection(Random& random);
 
-class Meat: public Entity
-{
-public:
-    Meat(World* _world);
-    virtual ~Meat();
+private:
+    Grid<std::uint32_t> entitiesTable;
 
-    void Draw(wxDC* dc) final;
-    void DrawSelected(wxDC* dc) final;
-};
+    EmptyPoints emptyPoints;
 
+    // live cells, a step costs O(cells) instead of O(area)
+    CellStore cells;
 
+    // names of genes are kept once, cells refer to them by indices
+    std::vector<std::string> geneNames;
 
-class Cell: public Entity
-{
-public:
-    Cell(World* _world, const wxString& geneName);
-    Cell(World* _world, int _divEnergy, int _damage, int _mutationProbability, const wxColor& _color, const Gene& _gene);
+    std::vector<int> census;
+    SpeciesRegistry speciesRegistry;
 
-    virtual ~Cell();
+    LineageTree speciesLineage;
+    LineageTree cellLineage;
+    LineageLog lineageLog;
 
-    void Step() final;
-    void Draw(wxDC* dc) final;
-    void DrawSelected(wxDC* dc) final;
+    std::string lineageLogFile;
+    bool lineageCellsOption {false};
+    std::size_t lineageBudgetOption {LineageTree::defaultBudget};
+    bool cellLineageEnabled {false};
 
-    bool Attack(Cell* victim);
-    void SetAttacked(bool _attacked);
+    // all live cells by handles, and slots of them by ids
+    SlotMap<std::uint32_t> entities;
+    IdIndex<std::uint32_t> cellIds;
 
-    const Gene& GetGene();
-    void SetGene(const Gene& _gene);
+    // plants and meat are scheduled once when created; a timer isn't
+    // cancelled when its food was eaten, it is ignored when the field holds
+    // another record
+    TimingWheel<Point> expiryWheel;
 
-    wxString Get(const wxString& name) override;
+    // indices of dead cells in the store, they don't change till DeathHandle
+    std::vector<std::uint32_t> deadCells;
+    std::vector<Point> deadFood;
 
-private:
-    void Clone();
-    void Execute(int cmd);
+    Scheduler scheduler;
 
-    Gene GenerateGene(const wxString& name);
-    Gene MutateGene(const Gene& _gene);
+    // a context per worker and the context of the step, where records of
+    // tiles are merged and serial actions are recorded
+    WorkerPool workers;
+    std::vector<StepContext> contexts;
+    StepContext stepContext;
 
-    wxColor GenerateColor();
-    wxPoint GenerateDirection();
+    std::vector<TileRun> tileRuns;
 
-    bool CanDivide();
-    void DrawDirection(wxDC* dc);
+    // children of the current phase by rows of the room, from birthsFirst
+    std::vector<Birth> births;
+    std::uint32_t birthsFirst {0};
 
-    int NormalizeCoord(int x);
+    std::vector<Intent> intents;
+    std::vector<Contender> contenders;
 
-    void SetLastBehavior(const wxString& behavior);
+    // Z-order codes with indices of cells and the new order of the store
+    std::vector<std::uint64_t> compactionKeys;
+    std::vector<std::uint64_t> compactionScratch;
+    std::vector<std::uint32_t> compactionOrder;
+    std::vector<CellBlock> compactionBlocks;
 
-private:
-    wxPoint direction {wxPoint(1,0)};
+    std::uint64_t seed {0};
+    bool seedFixed {false};
+    int nextId {0};
 
-    Gene gen1;
+    // plants and meat are selected by a field and the record in it
+    Handle selected;
+    Point selectedFood {Point(-1,-1)};
+    std::uint32_t selectedFoodRef {0};
+    int steps {0};
 
-    int divEnergy {0};
-    int damage {0};
-    int childrenCounter {0};
-    int killsCounter {0};
-    int mutationProbability {0};
-    int eatenPlantsCounter {0};
-    int eatenMeatCounter {0};
+    int plantsCounter {0};
+    int meatCounter {0};
+    int cellsCounter {0};
 
-    bool attacked {false};
+    GlobalProperties* properties {nullptr};
+    SimParams params;
 
-    wxString lastBehavior {""};
+    Size worldSize {Size(0,0)};
 };
 
 }
@@ -9,14 +9,16 @@
 #ifndef _GENE_H_
 #define _GENE_H_
 
-#include <wx/string.h>
+#include <string>
+#include <array>
+#include <cstdint>
 
 namespace ProtoPuddle
 {
 
 struct Gene
 {
-    explicit Gene(const wxString& _name = ""): name(_name) {}
+    explicit Gene(const std::string& _name = ""): name(_name) {}
 
     Gene(const Gene& src) {
         name = src.name;
@@ -61,7 +63,36 @@ struct Gene
         ACTION_EAT
     };
 
-    wxString name {""};
+    // situations which a cell faces, a gene has an action for every of them
+    enum
+    {
+        SITUATION_EMPTY = 0,
+        SITUATION_OTHER,
+        SITUATION_SAME,
+        SITUATION_MEAT,
+        SITUATION_PLANT,
+        SITUATION_WALL,
+        SITUATION_WEAK,
+        SITUATION_DEAD,
+        SITUATION_QUANTITY
+    };
+
+    // compact form of a gene (without a name), actions are indexed by situations
+    using Code = std::array<std::uint8_t, SITUATION_QUANTITY>;
+
+    Gene(const std::string& _name, const Code& code): name(_name)
+    {
+        empty = code[SITUATION_EMPTY];
+        other = code[SITUATION_OTHER];
+        same = code[SITUATION_SAME];
+        meat = code[SITUATION_MEAT];
+        plant = code[SITUATION_PLANT];
+        wall = code[SITUATION_WALL];
+        weak = code[SITUATION_WEAK];
+        dead = code[SITUATION_DEAD];
+    }
+
+    std::string name {""};
 
     int empty {ACTION_NONE};
     int other {ACTION_NONE};
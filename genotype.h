@@ -0,0 +1,113 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:               genotype.h
+// Description:        Compact integer encoding of genes
+// Author:             Alexey Orlov (https://github.com/m110h)
+// Last modification:  18/08/2020
+// Licence:            MIT licence
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _GENOTYPE_H_
+#define _GENOTYPE_H_
+
+#include <array>
+#include <cstdint>
+
+#include "gene.h"
+
+namespace ProtoPuddle
+{
+
+// Actions of a gene are taken from a small alphabet per situation, so a gene
+// is a number in a mixed radix: the digit of a situation is an index in its
+// alphabet. There are 4*3*3*4*4*2*2*3 = 6912 genotypes, an id fits 16 bits
+// and a copy of a gene is a copy of the id.
+class Genotype
+{
+public:
+    static const int quantity {6912};
+
+    static int GetRadix(int situation)
+    {
+        return GetAlphabets()[situation].size;
+    }
+
+    static int GetDigit(std::uint16_t genotype, int situation)
+    {
+        return (genotype / GetWeights()[situation]) % GetRadix(situation);
+    }
+
+    static std::uint16_t SetDigit(std::uint16_t genotype, int situation, int digit)
+    {
+        const int weight = GetWeights()[situation];
+
+        return static_cast<std::uint16_t>(genotype + (digit - GetDigit(genotype, situation)) * weight);
+    }
+
+    // actions of all genotypes are decoded once, 54 KB
+    static const Gene::Code& Decode(std::uint16_t genotype)
+    {
+        static const std::array<Gene::Code, quantity> codes = [] {
+            std::array<Gene::Code, quantity> table;
+
+            for (int g=0; g<quantity; g++)
+            {
+                for (int s=0; s<Gene::SITUATION_QUANTITY; s++)
+                {
+                    const Alphabet& alphabet = GetAlphabets()[s];
+
+                    table[g][s] = static_cast<std::uint8_t>(alphabet.actions[GetDigit(static_cast<std::uint16_t>(g), s)]);
+                }
+            }
+
+            return table;
+        }();
+
+        return codes[genotype];
+    }
+
+private:
+    struct Alphabet
+    {
+        int size;
+        std::array<int, 4> actions;
+    };
+
+    // sets of behavior
+    static const std::array<Alphabet, Gene::SITUATION_QUANTITY>& GetAlphabets()
+    {
+        static const std::array<Alphabet, Gene::SITUATION_QUANTITY> alphabets {{
+            { 4, { Gene::ACTION_TURN_L, Gene::ACTION_TURN_R, Gene::ACTION_MOVE, Gene::ACTION_NONE } },   // empty
+            { 3, { Gene::ACTION_TURN_L, Gene::ACTION_TURN_R, Gene::ACTION_ATTACK } },                    // other
+            { 3, { Gene::ACTION_TURN_L, Gene::ACTION_TURN_R, Gene::ACTION_ATTACK } },                    // same
+            { 4, { Gene::ACTION_TURN_L, Gene::ACTION_TURN_R, Gene::ACTION_NONE, Gene::ACTION_EAT } },    // meat
+            { 4, { Gene::ACTION_TURN_L, Gene::ACTION_TURN_R, Gene::ACTION_NONE, Gene::ACTION_EAT } },    // plant
+            { 2, { Gene::ACTION_TURN_L, Gene::ACTION_TURN_R } },                                         // wall
+            { 2, { Gene::ACTION_TURN_L, Gene::ACTION_TURN_R } },                                         // weak
+            { 3, { Gene::ACTION_TURN_L, Gene::ACTION_TURN_R, Gene::ACTION_NONE } }                       // dead
+        }};
+
+        return alphabets;
+    }
+
+    static const std::array<int, Gene::SITUATION_QUANTITY>& GetWeights()
+    {
+        static const std::array<int, Gene::SITUATION_QUANTITY> weights = [] {
+            std::array<int, Gene::SITUATION_QUANTITY> w;
+            int weight = 1;
+
+            for (int s=0; s<Gene::SITUATION_QUANTITY; s++)
+            {
+                w[s] = weight;
+                weight *= GetAlphabets()[s].size;
+            }
+
+            return w;
+        }();
+
+        return weights;
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,179 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:               grid.h
+// Description:        Dynamically sized world grid stored as square chunks
+// Author:             Alexey Orlov (https://github.com/m110h)
+// Last modification:  18/08/2020
+// Licence:            MIT licence
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _GRID_H_
+#define _GRID_H_
+
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <iterator>
+#include <cstddef>
+
+#include "types.h"
+
+namespace ProtoPuddle
+{
+
+// The grid is split into chunks of chunkSize x chunkSize fields. A chunk is
+// allocated only when a non-empty value is written into it, so a big world
+// costs only a table of pointers until entities appear there. Fields of a
+// chunk are stored row by row, therefore neighbours lie in the same or in the
+// adjacent cache lines.
+template <class T>
+class Grid
+{
+public:
+    static const int chunkShift {6};
+    static const int chunkSize {1 << chunkShift};
+    static const int chunkMask {chunkSize - 1};
+
+    struct alignas(64) Chunk
+    {
+        T fields[chunkSize*chunkSize] {};
+    };
+
+    Grid() {}
+
+    Grid(const Grid& src) = delete;
+    Grid& operator=(const Grid& r) = delete;
+
+    ~Grid() {}
+
+    // a grid of the same size keeps its chunks and only clears them, so a new
+    // world takes no memory until it spreads beyond the former one
+    void Reset(int _width, int _height)
+    {
+        if (_width == width && _height == height)
+        {
+            for (std::unique_ptr<Chunk>& chunk: chunks)
+            {
+                if (chunk != nullptr)
+                    std::fill(std::begin(chunk->fields), std::end(chunk->fields), T());
+            }
+
+            return;
+        }
+
+        width = _width;
+        height = _height;
+
+        chunksX = (width + chunkMask) >> chunkShift;
+        chunksY = (height + chunkMask) >> chunkShift;
+
+        chunks.clear();
+        chunks.shrink_to_fit();
+        chunks.resize(static_cast<std::size_t>(chunksX) * chunksY);
+
+        allocatedChunks = 0;
+    }
+
+    int GetWidth() const { return width; }
+    int GetHeight() const { return height; }
+
+    T Get(const Point& p) const
+    {
+        const Chunk* chunk = chunks[ChunkIndex(p)].get();
+
+        if (chunk == nullptr)
+            return T();
+
+        return chunk->fields[FieldIndex(p)];
+    }
+
+    void Set(const Point& p, const T& value)
+    {
+        std::unique_ptr<Chunk>& chunk = chunks[ChunkIndex(p)];
+
+        if (chunk == nullptr)
+        {
+            if (value == T())
+                return;
+
+            chunk.reset(new Chunk());
+            allocatedChunks++;
+        }
+
+        chunk->fields[FieldIndex(p)] = value;
+    }
+
+    // allocates the chunk of a field in advance: several threads may write
+    // into allocated chunks at once, but not allocate them
+    void Allocate(const Point& p)
+    {
+        std::unique_ptr<Chunk>& chunk = chunks[ChunkIndex(p)];
+
+        if (chunk == nullptr)
+        {
+            chunk.reset(new Chunk());
+            allocatedChunks++;
+        }
+    }
+
+    // calls f(position, value) for all non-empty fields, the value can be modified
+    template <class F>
+    void ForEach(F f)
+    {
+        for (int cy=0; cy<chunksY; cy++)
+        {
+            for (int cx=0; cx<chunksX; cx++)
+            {
+                Chunk* chunk = chunks[static_cast<std::size_t>(cy)*chunksX + cx].get();
+
+                if (chunk == nullptr)
+                    continue;
+
+                const int x0 = cx << chunkShift;
+                const int y0 = cy << chunkShift;
+
+                for (int i=0; i<chunkSize*chunkSize; i++)
+                {
+                    if (chunk->fields[i] == T())
+                        continue;
+
+                    f(Point(x0 + (i & chunkMask), y0 + (i >> chunkShift)), chunk->fields[i]);
+                }
+            }
+        }
+    }
+
+    std::size_t GetAllocatedChunks() const
+    {
+        return allocatedChunks;
+    }
+
+    std::size_t GetMemoryUsage() const
+    {
+        return chunks.capacity()*sizeof(std::unique_ptr<Chunk>) + allocatedChunks*sizeof(Chunk);
+    }
+
+private:
+    std::size_t ChunkIndex(const Point& p) const
+    {
+        return static_cast<std::size_t>(p.y >> chunkShift)*chunksX + (p.x >> chunkShift);
+    }
+
+    static int FieldIndex(const Point& p)
+    {
+        return ((p.y & chunkMask) << chunkShift) | (p.x & chunkMask);
+    }
+
+private:
+    int width {0};
+    int height {0};
+
+    int chunksX {0};
+    int chunksY {0};
+
+    std::vector<std::unique_ptr<Chunk>> chunks;
+    std::size_t allocatedChunks {0};
+};
+
+}
+
+#endif
@@ -0,0 +1,164 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:               idindex.h
+// Description:        Index of values by ids of entities
+// Author:             Alexey Orlov (https://github.com/m110h)
+// Last modification:  18/08/2020
+// Licence:            MIT licence
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _ID_INDEX_H_
+#define _ID_INDEX_H_
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+namespace ProtoPuddle
+{
+
+// An open addressing table of non-negative ids with linear probing. A removed
+// entry is filled by shifting the following entries of its run back, so
+// there are no tombstones and a search stops at the first empty entry. The
+// table is at most half full; it grows only when it is fuller than ever
+// before and keeps its size when it is cleared.
+template <class T>
+class IdIndex
+{
+public:
+    IdIndex() {}
+
+    IdIndex(const IdIndex& src) = delete;
+    IdIndex& operator=(const IdIndex& r) = delete;
+
+    ~IdIndex() {}
+
+    void Clear()
+    {
+        std::fill(entries.begin(), entries.end(), Entry());
+        quantity = 0;
+    }
+
+    // an id which is already there gets the new value
+    void Insert(int id, const T& value)
+    {
+        if (2*(quantity + 1) > entries.size())
+            Grow();
+
+        std::size_t i = Home(id);
+
+        while (entries[i].id != empty && entries[i].id != id)
+            i = (i + 1) & mask;
+
+        if (entries[i].id == empty)
+            quantity++;
+
+        entries[i].id = id;
+        entries[i].value = value;
+    }
+
+    void Remove(int id)
+    {
+        if (entries.empty())
+            return;
+
+        std::size_t i = Home(id);
+
+        while (entries[i].id != id)
+        {
+            if (entries[i].id == empty)
+                return;
+
+            i = (i + 1) & mask;
+        }
+
+        // an entry of the run moves into the hole unless its home lies
+        // cyclically in (hole, entry]
+        std::size_t hole = i;
+
+        for (std::size_t j = (i + 1) & mask; entries[j].id != empty; j = (j + 1) & mask)
+        {
+            const std::size_t home = Home(entries[j].id);
+
+            if (((j - home) & mask) >= ((j - hole) & mask))
+            {
+                entries[hole] = entries[j];
+                hole = j;
+            }
+        }
+
+        entries[hole] = Entry();
+        quantity--;
+    }
+
+    // returns nullptr if there isn't the id
+    const T* Find(int id) const
+    {
+        if (entries.empty() || id < 0)
+            return nullptr;
+
+        for (std::size_t i = Home(id); entries[i].id != empty; i = (i + 1) & mask)
+        {
+            if (entries[i].id == id)
+                return &entries[i].value;
+        }
+
+        return nullptr;
+    }
+
+    std::size_t GetQuantity() const
+    {
+        return quantity;
+    }
+
+    std::size_t GetMemoryUsage() const
+    {
+        return entries.capacity()*sizeof(Entry);
+    }
+
+private:
+    static const int empty {-1};
+
+    struct Entry
+    {
+        int id {empty};
+        T value {};
+    };
+
+    // Fibonacci hashing, the high bits of a product are mixed best
+    std::size_t Home(int id) const
+    {
+        return static_cast<std::size_t>((static_cast<std::uint64_t>(static_cast<std::uint32_t>(id)) * 0x9e3779b97f4a7c15ULL) >> shift);
+    }
+
+    void Grow()
+    {
+        std::vector<Entry> old(std::max<std::size_t>(16, 2*entries.size()));
+
+        old.swap(entries);
+
+        mask = entries.size() - 1;
+        shift = 64;
+
+        for (std::size_t size = entries.size(); size > 1; size >>= 1)
+            shift--;
+
+        quantity = 0;
+
+        for (const Entry& entry: old)
+        {
+            if (entry.id != empty)
+                Insert(entry.id, entry.value);
+        }
+    }
+
+private:
+    std::vector<Entry> entries;
+    std::size_t mask {0};
+    int shift {64};
+    std::size_t quantity {0};
+};
+
+}
+
+#endif
@@ -0,0 +1,315 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:               lineage.h
+// Description:        Trees of descent and the log of branching events
+// Author:             Alexey Orlov (https://github.com/m110h)
+// Last modification:  18/08/2020
+// Licence:            MIT licence
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _LINEAGE_H_
+#define _LINEAGE_H_
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <limits>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+namespace ProtoPuddle
+{
+
+// One step of an ancestry: a species or a cell (by its serial number or id),
+// when it appeared, which locus (situation of a gene) was mutated and how many
+// extinct ancestors above it were dropped to keep the tree within its budget.
+struct LineageRecord
+{
+    static const std::uint8_t noLocus {0xff};
+
+    std::uint32_t key {0};
+    std::uint32_t step {0};
+    std::uint8_t locus {noLocus};
+    std::uint32_t skipped {0};
+};
+
+// A tree of descent of species or of cells. A node is held by its own life
+// and by its children; when both are gone it is removed and releases its
+// parent, so only ancestors of living nodes are kept. When the tree grows
+// over its budget, extinct nodes with a single child are spliced out: living
+// nodes and branching points stay exact and there are less than two nodes
+// per living node, however long the history is.
+class LineageTree
+{
+public:
+    static const std::uint32_t noNode {std::numeric_limits<std::uint32_t>::max()};
+    static const std::size_t defaultBudget {std::size_t(1) << 20};
+
+    LineageTree() {}
+
+    LineageTree(const LineageTree& src) = delete;
+    LineageTree& operator=(const LineageTree& r) = delete;
+
+    ~LineageTree() {}
+
+    void Clear()
+    {
+        nodes.clear();
+        freeNode = noNode;
+        quantity = 0;
+        threshold = budget;
+    }
+
+    // the budget is a quantity of nodes
+    void SetBudget(std::size_t _budget)
+    {
+        budget = std::max<std::size_t>(_budget, 2);
+        threshold = budget;
+    }
+
+    std::uint32_t Add(std::uint32_t parent, std::uint32_t key, std::uint32_t step, std::uint8_t locus)
+    {
+        if (quantity >= threshold)
+            Compact();
+
+        std::uint32_t index = freeNode;
+
+        if (index != noNode)
+        {
+            freeNode = nodes[index].parent;
+        }
+        else
+        {
+            index = static_cast<std::uint32_t>(nodes.size());
+            nodes.emplace_back();
+        }
+
+        Node& node = nodes[index];
+
+        node.parent = parent;
+        node.children = 0;
+        node.alive = true;
+        node.record.key = key;
+        node.record.step = step;
+        node.record.locus = locus;
+        node.record.skipped = 0;
+
+        if (parent != noNode)
+            nodes[parent].children++;
+
+        quantity++;
+
+        return index;
+    }
+
+    // the living node has died
+    void Release(std::uint32_t index)
+    {
+        if (index == noNode)
+            return;
+
+        nodes[index].alive = false;
+
+        // extinct branches are removed up to the first node which is held
+        while (index != noNode && !nodes[index].alive && nodes[index].children == 0)
+        {
+            const std::uint32_t parent = nodes[index].parent;
+
+            Free(index);
+
+            if (parent != noNode)
+                nodes[parent].children--;
+
+            index = parent;
+        }
+    }
+
+    // from the node to the oldest kept ancestor
+    void GetAncestry(std::uint32_t index, std::vector<LineageRecord>& ancestry) const
+    {
+        ancestry.clear();
+
+        while (index != noNode)
+        {
+            ancestry.push_back(nodes[index].record);
+            index = nodes[index].parent;
+        }
+    }
+
+    std::size_t GetQuantity() const
+    {
+        return quantity;
+    }
+
+    std::size_t GetMemoryUsage() const
+    {
+        return nodes.capacity()*sizeof(Node);
+    }
+
+private:
+    struct Node
+    {
+        LineageRecord record;
+
+        // the next free node for a free node
+        std::uint32_t parent {noNode};
+        std::uint32_t children {0};
+
+        bool alive {false};
+    };
+
+    void Free(std::uint32_t index)
+    {
+        nodes[index].alive = false;
+        nodes[index].children = 0;
+        nodes[index].parent = freeNode;
+
+        freeNode = index;
+        quantity--;
+    }
+
+    bool IsFree(std::uint32_t index) const
+    {
+        const Node& node = nodes[index];
+
+        return !node.alive && node.children == 0;
+    }
+
+    // An extinct node with one child is referenced by that child only, so
+    // the child takes its parent. The next compaction happens when the tree
+    // doubles, it keeps the cost amortized if living nodes fill the budget.
+    void Compact()
+    {
+        for (std::uint32_t i=0; i<nodes.size(); i++)
+        {
+            if (IsFree(i))
+                continue;
+
+            Node& node = nodes[i];
+
+            while (node.parent != noNode)
+            {
+                Node& parent = nodes[node.parent];
+
+                if (parent.alive || parent.children != 1)
+                    break;
+
+                const std::uint32_t grandParent = parent.parent;
+
+                node.record.skipped += 1 + parent.record.skipped;
+
+                Free(node.parent);
+                node.parent = grandParent;
+            }
+        }
+
+        threshold = std::max(budget, 2*quantity);
+    }
+
+private:
+    std::vector<Node> nodes;
+    std::uint32_t freeNode {noNode};
+    std::size_t quantity {0};
+
+    std::size_t budget {defaultBudget};
+    std::size_t threshold {defaultBudget};
+};
+
+// Append-only binary log of branching events of species. The file starts
+// with "PPLG" and a version (uint32), then 13-byte little-endian records:
+// child serial, parent serial (0xffffffff for initial sorts), step (uint32
+// each) and the mutated locus (uint8). Records are buffered, so memory
+// doesn't depend on the length of a run.
+class LineageLog
+{
+public:
+    static const std::uint32_t version {1};
+    static const std::size_t recordSize {13};
+
+    LineageLog() {}
+
+    LineageLog(const LineageLog& src) = delete;
+    LineageLog& operator=(const LineageLog& r) = delete;
+
+    ~LineageLog()
+    {
+        Close();
+    }
+
+    bool Open(const std::string& filename)
+    {
+        Close();
+
+        out.open(filename, std::ios::binary | std::ios::trunc);
+
+        if (!out)
+            return false;
+
+        records = 0;
+        buffer.reserve(bufferSize);
+
+        out.write("PPLG", 4);
+        Put(version);
+
+        return true;
+    }
+
+    void Close()
+    {
+        if (!out.is_open())
+            return;
+
+        Flush();
+        out.close();
+    }
+
+    bool IsOpen() const
+    {
+        return out.is_open();
+    }
+
+    void Append(std::uint32_t child, std::uint32_t parent, std::uint32_t step, std::uint8_t locus)
+    {
+        if (!out.is_open())
+            return;
+
+        Put(child);
+        Put(parent);
+        Put(step);
+        buffer.push_back(static_cast<char>(locus));
+
+        records++;
+
+        if (buffer.size() >= bufferSize)
+            Flush();
+    }
+
+    void Flush()
+    {
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+
+    std::uint64_t GetRecords() const
+    {
+        return records;
+    }
+
+private:
+    static const std::size_t bufferSize {recordSize * 4096};
+
+    void Put(std::uint32_t value)
+    {
+        for (int i=0; i<4; i++)
+            buffer.push_back(static_cast<char>((value >> (8*i)) & 0xff));
+    }
+
+private:
+    std::ofstream out;
+    std::vector<char> buffer;
+    std::uint64_t records {0};
+};
+
+}
+
+#endif
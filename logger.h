@@ -0,0 +1,55 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:               logger.h
+// Description:        Log sink of the simulation core
+// Author:             Alexey Orlov (https://github.com/m110h)
+// Last modification:  18/08/2020
+// Licence:            MIT licence
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _LOGGER_H_
+#define _LOGGER_H_
+
+#include <string>
+#include <functional>
+#include <iostream>
+
+namespace ProtoPuddle
+{
+
+// The core doesn't know anything about wxLog, so the GUI installs its own
+// handler; by default messages go to the standard error stream.
+class Logger
+{
+public:
+    using Handler = std::function<void(const std::string&)>;
+
+    static void SetHandler(const Handler& _handler)
+    {
+        GetHandler() = _handler;
+    }
+
+    static void Message(const std::string& message)
+    {
+        Handler& handler = GetHandler();
+
+        if (handler)
+        {
+            handler(message);
+        }
+        else
+        {
+            std::cerr << message << std::endl;
+        }
+    }
+
+private:
+    static Handler& GetHandler()
+    {
+        static Handler handler;
+        return handler;
+    }
+};
+
+}
+
+#endif
@@ -16,11 +16,15 @@
 #include <wx/statline.h>
 #include <wx/spinctrl.h>
 
+#include <thread>
+#include <algorithm>
+
 #include "propertiesdialog.h"
 #include "genesframe.h"
 #include "drawpanel.h"
 #include "entities.h"
 #include "constants.h"
+#include "logger.h"
 
 #include "properties_singleton.h"
 
@@ -41,6 +45,7 @@ public:
     void OnSwitchDrawWorld(wxCommandEvent& event);
     void OnSwitchAntialiasing(wxCommandEvent& event);
     void OnProperties(wxCommandEvent& event);
+    void OnFixedSeed(wxCommandEvent& event);
     void OnDescription(wxCommandEvent& event);
     void OnLogWindow(wxCommandEvent& event);
     void OnAbout(wxCommandEvent& event);
@@ -53,6 +58,7 @@ public:
         myID_MENU_EDIT_ANTIALIASING,
 #endif
         myID_MENU_EDIT_PROPERTIES,
+        myID_MENU_EDIT_FIXED_SEED,
         myID_MENU_HELP_SHOW_DESCRIPTION,
         myID_MENU_HELP_SHOW_LOG
     };
@@ -73,11 +79,13 @@ private:
     wxSpinCtrl* peSpinCtrl {nullptr};
     wxSpinCtrl* meSpinCtrl {nullptr};
     wxSpinCtrl* mdSpinCtrl {nullptr};
+    wxSpinCtrl* thSpinCtrl {nullptr};
 
     wxStaticText* topIdText {nullptr};
     wxStaticText* cellsCountText {nullptr};
     wxStaticText* plantsCountText {nullptr};
     wxStaticText* meatCountText {nullptr};
+    wxStaticText* speciesCountText {nullptr};
 
     wxStaticText* idText {nullptr};
     wxStaticText* ageText {nullptr};
@@ -91,6 +99,7 @@ private:
     wxStaticText* eatenPlantsText {nullptr};
     wxStaticText* eatenMeatText {nullptr};
     wxStaticText* lastBehaviorText {nullptr};
+    wxStaticText* speciesText {nullptr};
 
     wxButton* showGenesBtn {nullptr};
 
@@ -130,6 +139,10 @@ MyFrame::MyFrame(): wxFrame(nullptr, wxID_ANY, wxT("ProtoPuddle++"), wxDefaultPo
     logWindow = new wxLogWindow(NULL, "ProtoPuddle++ Log", false, false);
     wxLog::SetActiveTarget(logWindow);
 
+    ProtoPuddle::Logger::SetHandler([](const std::string& message) {
+        wxLogMessage("%s", wxString(message));
+    });
+
     wxLogMessage("Log initialization is done.");
 
     MakeMenu();
@@ -137,7 +150,7 @@ MyFrame::MyFrame(): wxFrame(nullptr, wxID_ANY, wxT("ProtoPuddle++"), wxDefaultPo
     Setting();
     MakeLayout();
 
-    world = new ProtoPuddle::World(this, PropertiesSingleton::getInstance().GetPropertiesPtr());
+    world = new ProtoPuddle::World(PropertiesSingleton::getInstance().GetPropertiesPtr());
     world->New();
 
     if (worldView)
@@ -159,6 +172,7 @@ MyFrame::MyFrame(): wxFrame(nullptr, wxID_ANY, wxT("ProtoPuddle++"), wxDefaultPo
             StopSimulation();
 
         UpdateQuickSettings();
+        world->ApplyProperties();
 
         if (flag)
             StartSimulation();
@@ -209,12 +223,13 @@ void MyFrame::OnOpen(wxCommandEvent& WXUNUSED(event))
 
     if (dlg.ShowModal() == wxID_OK)
     {
-        auto [flag, error] = world->OpenFromFile(dlg.GetPath());
+        auto [flag, error] = world->OpenFromFile(dlg.GetPath().ToStdString());
 
         if (flag)
         {
             NewWorld();
             UpdateQuickSettings();
+            GetMenuBar()->Check(myID_MENU_EDIT_FIXED_SEED, world->IsSeedFixed());
             SetStatusText(wxT("Configuration has been opened"), 1);
         }
         else
@@ -232,7 +247,7 @@ void MyFrame::OnSave(wxCommandEvent& WXUNUSED(event))
 
     if (dlg.ShowModal() == wxID_OK)
     {
-        if (world->SaveToFile(dlg.GetPath()))
+        if (world->SaveToFile(dlg.GetPath().ToStdString()))
         {
             SetStatusText(wxT("Configuration has been saved"), 1);
         }
@@ -247,6 +262,22 @@ void MyFrame::OnQuit(wxCommandEvent& event)
     Close(true);
 }
 
+// a fixed seed makes New repeat the current world and is saved with the
+// configuration, otherwise every world is new
+void MyFrame::OnFixedSeed(wxCommandEvent& event)
+{
+    if (event.IsChecked())
+    {
+        world->SetSeed(world->GetSeed());
+        SetStatusText(wxString::Format(wxT("Seed %llu is fixed"), static_cast<unsigned long long>(world->GetSeed())), 1);
+    }
+    else
+    {
+        world->ResetSeed();
+        SetStatusText(wxT("Seed is random"), 1);
+    }
+}
+
 void MyFrame::OnSimulation(wxCommandEvent& event)
 {
     SwitchSimulation();
@@ -359,7 +390,7 @@ void MyFrame::StartSimulation()
     {
         ProtoPuddle::GlobalProperties properties = PropertiesSingleton::getInstance().GetProperties();
 
-        timer.Start(1000 / properties.GetValue(wxString("stepsPerSecond")));
+        timer.Start(1000 / properties.GetValue("stepsPerSecond"));
 
         SetStatusText(wxT("Simulation has been started"), 1);
     }
@@ -396,11 +427,11 @@ void MyFrame::UpdateQuickSettings()
 {
     ProtoPuddle::GlobalProperties* properties = PropertiesSingleton::getInstance().GetPropertiesPtr();
 
-    spsSpinCtrl->SetValue(properties->GetValue(wxString("stepsPerSecond")));
-    ppsSpinCtrl->SetValue(properties->GetValue(wxString("plantsPerStep")));
-    peSpinCtrl->SetValue(properties->GetValue(wxString("plantEnergy")));
-    meSpinCtrl->SetValue(properties->GetValue(wxString("meatEnergy")));
-    mdSpinCtrl->SetValue(properties->GetValue(wxString("maxDamage")));
+    spsSpinCtrl->SetValue(properties->GetValue("stepsPerSecond"));
+    ppsSpinCtrl->SetValue(properties->GetValue("plantsPerStep"));
+    peSpinCtrl->SetValue(properties->GetValue("plantEnergy"));
+    meSpinCtrl->SetValue(properties->GetValue("meatEnergy"));
+    mdSpinCtrl->SetValue(properties->GetValue("maxDamage"));
 
     wxLogMessage(wxT("Quick settings was updated."));
 }
@@ -414,25 +445,27 @@ void MyFrame::UpdateInformation()
     plantsCountText->SetLabel(wxString::Format(wxT("%d"), p));
     meatCountText->SetLabel(wxString::Format(wxT("%d"), m));
     cellsCountText->SetLabel(wxString::Format(wxT("%d"), c));
+    speciesCountText->SetLabel(wxString::Format(wxT("%d"), static_cast<int>(world->GetSpecies().GetQuantity())));
 
-    ProtoPuddle::Entity* e = world->GetSelectedEntity();
+    ProtoPuddle::EntityView e = world->GetSelectedEntity();
 
     if (e)
     {
-        idText->SetLabel(e->Get("id"));
-        ageText->SetLabel(e->Get("age"));
-        maxAgeText->SetLabel(e->Get("maxAge"));
-        energyText->SetLabel(e->Get("energy"));
-        divEnergyText->SetLabel(e->Get("divEnergy"));
-        mutationText->SetLabel(e->Get("mutation"));
-        damageText->SetLabel(e->Get("damage"));
-        killsText->SetLabel(e->Get("kills"));
-        childrensText->SetLabel(e->Get("childrens"));
-        eatenPlantsText->SetLabel(e->Get("eatenPlants"));
-        eatenMeatText->SetLabel(e->Get("eatenMeat"));
-        lastBehaviorText->SetLabel(e->Get("lastBehavior"));
-
-        if (e->GetType() == ProtoPuddle::Entity::TYPE_CELL)
+        idText->SetLabel(e.Get("id"));
+        ageText->SetLabel(e.Get("age"));
+        maxAgeText->SetLabel(e.Get("maxAge"));
+        energyText->SetLabel(e.Get("energy"));
+        divEnergyText->SetLabel(e.Get("divEnergy"));
+        mutationText->SetLabel(e.Get("mutation"));
+        damageText->SetLabel(e.Get("damage"));
+        killsText->SetLabel(e.Get("kills"));
+        childrensText->SetLabel(e.Get("childrens"));
+        eatenPlantsText->SetLabel(e.Get("eatenPlants"));
+        eatenMeatText->SetLabel(e.Get("eatenMeat"));
+        lastBehaviorText->SetLabel(e.Get("lastBehavior"));
+        speciesText->SetLabel(e.Get("species"));
+
+        if (e.GetType() == ProtoPuddle::EntityView::TYPE_CELL)
         {
             showGenesBtn->Enable();
         }
@@ -455,6 +488,7 @@ void MyFrame::UpdateInformation()
         eatenPlantsText->SetLabel(ProtoPuddle::unknownValueStr);
         eatenMeatText->SetLabel(ProtoPuddle::unknownValueStr);
         lastBehaviorText->SetLabel(ProtoPuddle::unknownValueStr);
+        speciesText->SetLabel(ProtoPuddle::unknownValueStr);
 
         showGenesBtn->Disable();
     }
@@ -464,8 +498,13 @@ void MyFrame::UpdateInformation()
 
 void MyFrame::UpdateMemoryInformation()
 {
+    if (!world)
+        return;
+
     auto [total, used, peak] = world->GetMemoryInfo();
-    wxString mi = wxString::Format("%s%llu%s%llu%s%llu", " [Memory in Bytes] -> Total: ", total, " | Used: ", used, " | Peak: ", peak);
+    auto [resident, reserved] = world->GetMemoryPages();
+
+    wxString mi = wxString::Format("%s%llu%s%llu%s%llu%s%llu", " [Memory in Bytes] -> Resident: ", resident, " of reserved ", reserved, " | Used: ", used, " | Peak: ", peak);
     SetStatusText(mi, 2);
 
     //wxLogMessage(mi);
@@ -502,13 +541,17 @@ void MyFrame::ApplySettings(wxCommandEvent& event)
     if (flag)
         StopSimulation();
 
-    properties.SetValue(wxString("stepsPerSecond"), spsSpinCtrl->GetValue());
-    properties.SetValue(wxString("plantsPerStep"), ppsSpinCtrl->GetValue());
-    properties.SetValue(wxString("plantEnergy"), peSpinCtrl->GetValue());
-    properties.SetValue(wxString("meatEnergy"), meSpinCtrl->GetValue());
-    properties.SetValue(wxString("maxDamage"), mdSpinCtrl->GetValue());
+    properties.SetValue("stepsPerSecond", spsSpinCtrl->GetValue());
+    properties.SetValue("plantsPerStep", ppsSpinCtrl->GetValue());
+    properties.SetValue("plantEnergy", peSpinCtrl->GetValue());
+    properties.SetValue("meatEnergy", meSpinCtrl->GetValue());
+    properties.SetValue("maxDamage", mdSpinCtrl->GetValue());
 
     PropertiesSingleton::getInstance().UpdateProperties(properties);
+    world->ApplyProperties();
+
+    // threads share the sense phase of the synchronous order only
+    world->SetThreads(thSpinCtrl->GetValue());
 
     if (flag)
         StartSimulation();
@@ -538,6 +581,7 @@ void MyFrame::MakeMenu()
     menuEdit->AppendCheckItem(myID_MENU_EDIT_ANTIALIASING, wxT("Enable &Antialiasing\tCtrl+a"));
 #endif
     menuEdit->Append(myID_MENU_EDIT_PROPERTIES, wxT("&Properties\tCtrl+p"));
+    menuEdit->AppendCheckItem(myID_MENU_EDIT_FIXED_SEED, wxT("&Fixed Seed"));
 
     wxMenu* menuHelp = new wxMenu;
 
@@ -589,6 +633,9 @@ void MyFrame::MakeMenu()
         case myID_MENU_EDIT_PROPERTIES:
             OnProperties(event);
             break;
+        case myID_MENU_EDIT_FIXED_SEED:
+            OnFixedSeed(event);
+            break;
         case myID_MENU_HELP_SHOW_DESCRIPTION:
             OnDescription(event);
             break;
@@ -633,27 +680,32 @@ void MyFrame::MakeLayout()
     wxStaticBox* settingsGroupBox = new wxStaticBox(sw, wxID_ANY, "Settings");
     wxStaticBoxSizer * vSettingsSizer = new wxStaticBoxSizer (settingsGroupBox, wxVERTICAL);
 
-    wxGridSizer* settingsSizer = new wxGridSizer(5, 2, 3, 0);
+    wxGridSizer* settingsSizer = new wxGridSizer(6, 2, 3, 0);
         settingsSizer->Add(new wxStaticText(settingsGroupBox, wxID_ANY, wxT("Steps per second")), 0, wxEXPAND);
             spsSpinCtrl = new wxSpinCtrl(settingsGroupBox, wxID_ANY);
-            spsSpinCtrl->SetRange(properties.GetMin(wxString("stepsPerSecond")) ,properties.GetMax(wxString("stepsPerSecond")));
+            spsSpinCtrl->SetRange(properties.GetMin("stepsPerSecond") ,properties.GetMax("stepsPerSecond"));
             settingsSizer->Add(spsSpinCtrl, 1, wxEXPAND);
         settingsSizer->Add(new wxStaticText(settingsGroupBox, wxID_ANY, wxT("Plants per step")), 0, wxEXPAND);
             ppsSpinCtrl = new wxSpinCtrl(settingsGroupBox, wxID_ANY);
-            ppsSpinCtrl->SetRange(properties.GetMin(wxString("plantsPerStep")) ,properties.GetMax(wxString("plantsPerStep")));
+            ppsSpinCtrl->SetRange(properties.GetMin("plantsPerStep") ,properties.GetMax("plantsPerStep"));
             settingsSizer->Add(ppsSpinCtrl, 1, wxEXPAND);
         settingsSizer->Add(new wxStaticText(settingsGroupBox, wxID_ANY, wxT("Plant energy")), 0, wxEXPAND);
             peSpinCtrl = new wxSpinCtrl(settingsGroupBox, wxID_ANY);
-            peSpinCtrl->SetRange(properties.GetMin(wxString("plantEnergy")) ,properties.GetMax(wxString("plantEnergy")));
+            peSpinCtrl->SetRange(properties.GetMin("plantEnergy") ,properties.GetMax("plantEnergy"));
             settingsSizer->Add(peSpinCtrl, 1, wxEXPAND);
         settingsSizer->Add(new wxStaticText(settingsGroupBox, wxID_ANY, wxT("Meat energy")), 0, wxEXPAND);
             meSpinCtrl = new wxSpinCtrl(settingsGroupBox, wxID_ANY);
-            meSpinCtrl->SetRange(properties.GetMin(wxString("meatEnergy")) ,properties.GetMax(wxString("meatEnergy")));
+            meSpinCtrl->SetRange(properties.GetMin("meatEnergy") ,properties.GetMax("meatEnergy"));
             settingsSizer->Add(meSpinCtrl, 1, wxEXPAND);
         settingsSizer->Add(new wxStaticText(settingsGroupBox, wxID_ANY, wxT("Max damage")), 0, wxEXPAND);
             mdSpinCtrl = new wxSpinCtrl(settingsGroupBox, wxID_ANY);
-            mdSpinCtrl->SetRange(properties.GetMin(wxString("maxDamage")) ,properties.GetMax(wxString("maxDamage")));
+            mdSpinCtrl->SetRange(properties.GetMin("maxDamage") ,properties.GetMax("maxDamage"));
             settingsSizer->Add(mdSpinCtrl, 1, wxEXPAND);
+        settingsSizer->Add(new wxStaticText(settingsGroupBox, wxID_ANY, wxT("Threads")), 0, wxEXPAND);
+            thSpinCtrl = new wxSpinCtrl(settingsGroupBox, wxID_ANY);
+            thSpinCtrl->SetRange(1, std::max(1, static_cast<int>(std::thread::hardware_concurrency())));
+            thSpinCtrl->SetValue(1);
+            settingsSizer->Add(thSpinCtrl, 1, wxEXPAND);
 
         UpdateQuickSettings();
 
@@ -671,7 +723,7 @@ void MyFrame::MakeLayout()
     wxStaticBox* infoGroupBox = new wxStaticBox(sw, wxID_ANY, "Common Information");
     wxStaticBoxSizer * vInfoSizer = new wxStaticBoxSizer (infoGroupBox, wxVERTICAL);
 
-    wxGridSizer* infoSizer = new wxGridSizer(4, 2, 3, 0);
+    wxGridSizer* infoSizer = new wxGridSizer(5, 2, 3, 0);
         infoSizer->Add(new wxStaticText(infoGroupBox, wxID_ANY, wxT("Top Id")));
             topIdText = new wxStaticText(infoGroupBox, wxID_ANY, wxT("0"));
             infoSizer->Add(topIdText);
@@ -684,6 +736,9 @@ void MyFrame::MakeLayout()
         infoSizer->Add(new wxStaticText(infoGroupBox, wxID_ANY, wxT("Meat count")));
             meatCountText = new wxStaticText(infoGroupBox, wxID_ANY, ProtoPuddle::unknownValueStr);
             infoSizer->Add(meatCountText);
+        infoSizer->Add(new wxStaticText(infoGroupBox, wxID_ANY, wxT("Species")));
+            speciesCountText = new wxStaticText(infoGroupBox, wxID_ANY, ProtoPuddle::unknownValueStr);
+            infoSizer->Add(speciesCountText);
 
     vInfoSizer->Add(infoSizer, 0, wxEXPAND);
     vswSizer->Add(vInfoSizer, 0, wxEXPAND | wxALL, 10);
@@ -693,7 +748,7 @@ void MyFrame::MakeLayout()
     wxStaticBox* selectedGroupBox = new wxStaticBox(sw, wxID_ANY, "Entity Information");
     wxStaticBoxSizer * vSelectedSizer = new wxStaticBoxSizer (selectedGroupBox, wxVERTICAL);
 
-    wxGridSizer* selectedSizer = new wxGridSizer(12, 2, 3, 0);
+    wxGridSizer* selectedSizer = new wxGridSizer(13, 2, 3, 0);
         selectedSizer->Add(new wxStaticText(selectedGroupBox, wxID_ANY, wxT("Id number")));
             idText = new wxStaticText(selectedGroupBox, wxID_ANY, ProtoPuddle::unknownValueStr);
             selectedSizer->Add(idText);
@@ -730,19 +785,21 @@ void MyFrame::MakeLayout()
         selectedSizer->Add(new wxStaticText(selectedGroupBox, wxID_ANY, wxT("Last behavior")));
             lastBehaviorText = new wxStaticText(selectedGroupBox, wxID_ANY, ProtoPuddle::unknownValueStr);
             selectedSizer->Add(lastBehaviorText);
+        selectedSizer->Add(new wxStaticText(selectedGroupBox, wxID_ANY, wxT("Species")));
+            speciesText = new wxStaticText(selectedGroupBox, wxID_ANY, ProtoPuddle::unknownValueStr);
+            selectedSizer->Add(speciesText);
 
     vSelectedSizer->Add(selectedSizer, 0, wxEXPAND);
     vSelectedSizer->Add(new wxStaticLine(selectedGroupBox, wxID_STATIC, wxDefaultPosition, wxDefaultSize, wxLI_HORIZONTAL), 0, wxGROW|wxTOP|wxBOTTOM, 10);
 
     showGenesBtn = new wxButton(selectedGroupBox, wxID_ANY, wxT("Show Genes"));
     showGenesBtn->Bind(wxEVT_BUTTON, [this](wxCommandEvent& event) {
-        ProtoPuddle::Entity* e = world->GetSelectedEntity();
+        ProtoPuddle::EntityView e = world->GetSelectedEntity();
 
-        if (e && e->GetType() == ProtoPuddle::Entity::TYPE_CELL)
+        if (e && e.GetType() == ProtoPuddle::EntityView::TYPE_CELL)
         {
-            ProtoPuddle::Cell* c = dynamic_cast<ProtoPuddle::Cell*>(e);
             GenesFrame* table = new GenesFrame(this, wxSize(500,400));
-                table->AddGene(c->GetGene());
+                table->AddGene(e.GetGene());
             table->Show();
         }
     });
@@ -0,0 +1,430 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:               poolallocator.h
+// Description:        Allocator of chunks of one size in pages which grow and shrink
+// Author:             Alexey Orlov (https://github.com/m110h)
+// Last modification:  18/08/2020
+// Licence:            MIT licence
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _POOL_ALLOCATOR_H_
+#define _POOL_ALLOCATOR_H_
+
+#include <new>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#include "thirdparty/allocator/allocator.h"
+
+namespace ProtoPuddle
+{
+
+// Equal chunks in pages of pageSize bytes. A page is mapped when all mapped
+// pages are full. A page whose chunks are free again stays mapped as a spare
+// one; Trim returns spare pages which weren't needed for a while (see below),
+// so a population which wavers near the border of a page doesn't map, zero
+// and unmap it on every step, but memory still follows the population. The
+// quantity of chunks is only a limit. Chunks of a new page are handed out in
+// turn, so untouched memory of a page isn't made resident by a free list.
+//
+// A free chunk keeps the next free one of its page in its first bytes, a page
+// is found from a chunk by the alignment of pages: Allocate and Free are
+// O(1). Pages with free chunks are listed, those which are more used come
+// first, so a crash of the population leaves whole pages empty.
+//
+// On Linux pages are mapped with mmap and are advised to be huge pages.
+//
+// GetTotal is the size of mapped pages, GetReserved is the limit.
+class PoolAllocator: public mtrebi::Allocator
+{
+public:
+    static const std::size_t alignment {64};
+    static const std::size_t pageSize {std::size_t(1) << 21};
+
+    PoolAllocator(std::size_t _chunkSize, std::size_t _chunks):
+        mtrebi::Allocator(0), chunkSize(RoundUp(_chunkSize))
+    {
+        chunksPerPage = (pageSize - RoundUp(sizeof(Page))) / chunkSize;
+        maxPages = chunksPerPage > 0 ? (_chunks + chunksPerPage - 1) / chunksPerPage : 0;
+    }
+
+    PoolAllocator(const PoolAllocator& src) = delete;
+    PoolAllocator& operator=(const PoolAllocator& r) = delete;
+
+    ~PoolAllocator()
+    {
+        Reset();
+    }
+
+    void* Allocate(const std::size_t size, const std::size_t _alignment = 0) final
+    {
+        if (size > chunkSize || _alignment > alignment || (available == nullptr && !MapPage()))
+        {
+            m_statistics.failures++;
+            return nullptr;
+        }
+
+        Page* page = available;
+
+        if (page->used == 0)
+        {
+            emptyPages--;
+
+            if (emptyPages < lowEmptyPages)
+                lowEmptyPages = emptyPages;
+        }
+
+        Chunk* chunk = page->freeChunk;
+
+        if (chunk != nullptr)
+        {
+            page->freeChunk = chunk->next;
+        }
+        else
+        {
+            chunk = reinterpret_cast<Chunk*>(FirstChunk(page) + page->fresh*chunkSize);
+            page->fresh++;
+        }
+
+        page->used++;
+
+        if (page->used == chunksPerPage)
+            Unlink(page);
+
+        m_used += chunkSize;
+
+        if (m_used > m_peak)
+            m_peak = m_used;
+
+        m_statistics.allocations++;
+        Statistics::CountWalk(m_statistics.allocateWalks, 0);
+
+        return chunk;
+    }
+
+    void Free(void* ptr) final
+    {
+        if (ptr == nullptr)
+            return;
+
+        Page* page = PageOf(ptr);
+        Chunk* chunk = static_cast<Chunk*>(ptr);
+
+        chunk->next = page->freeChunk;
+        page->freeChunk = chunk;
+
+        m_used -= chunkSize;
+
+        m_statistics.frees++;
+        Statistics::CountWalk(m_statistics.freeWalks, 0);
+
+        // a full page has free chunks again, it is the most used one
+        if (page->used == chunksPerPage)
+            PushFront(page);
+
+        page->used--;
+
+        if (page->used > 0)
+            return;
+
+        // spare pages are taken last
+        Unlink(page);
+        PushBack(page);
+
+        emptyPages++;
+    }
+
+    // It is called by the owner once in a while, e.g. once a step. Spare pages
+    // which stayed spare through trimWindow calls weren't needed by the
+    // population in that time, they are returned except a quarter of the used
+    // pages (one page at least), which is kept for a next growth.
+    void Trim()
+    {
+        if (++trims < trimWindow)
+            return;
+
+        const std::size_t keep = std::max<std::size_t>(1, (mappedPages - emptyPages)/4);
+        std::size_t surplus = lowEmptyPages > keep ? lowEmptyPages - keep : 0;
+
+        // spare pages lie at the end of the list of available pages
+        while (surplus > 0 && availableTail != nullptr && availableTail->used == 0)
+        {
+            Page* page = availableTail;
+
+            Unlink(page);
+            UnmapPage(page);
+
+            emptyPages--;
+            surplus--;
+        }
+
+        trims = 0;
+        lowEmptyPages = emptyPages;
+    }
+
+    void Init() final
+    {
+        Reset();
+    }
+
+    // all pages are returned
+    void Reset() final
+    {
+        while (pages != nullptr)
+        {
+            Page* page = pages;
+            pages = page->nextMapped;
+
+            Unmap(page);
+        }
+
+        available = nullptr;
+        availableTail = nullptr;
+        mappedPages = 0;
+        emptyPages = 0;
+        lowEmptyPages = 0;
+        trims = 0;
+
+        m_totalSize = 0;
+        m_used = 0;
+        m_peak = 0;
+
+        m_statistics = Statistics();
+    }
+
+    // Every free chunk is a free block. Chunks of a page which were never
+    // handed out lie in one piece at its end, the largest of such pieces is
+    // the largest free block: chunks freed among used ones are fragments.
+    Statistics GetStatistics() final
+    {
+        Statistics statistics = m_statistics;
+
+        for (Page* page = pages; page != nullptr; page = page->nextMapped)
+        {
+            const std::size_t freeChunks = chunksPerPage - page->used;
+            const std::size_t tail = (page->used == 0 ? chunksPerPage : chunksPerPage - page->fresh) * chunkSize;
+
+            statistics.freeBlocks += freeChunks;
+            statistics.freeSize += freeChunks * chunkSize;
+
+            if (tail > statistics.largestFreeBlock)
+                statistics.largestFreeBlock = tail;
+        }
+
+        if (statistics.freeBlocks > 0 && statistics.largestFreeBlock < chunkSize)
+            statistics.largestFreeBlock = chunkSize;
+
+        return statistics;
+    }
+
+    std::size_t GetChunkSize() const
+    {
+        return chunkSize;
+    }
+
+    std::size_t GetReserved() const
+    {
+        return maxPages * pageSize;
+    }
+
+private:
+    struct Chunk
+    {
+        Chunk* next;
+    };
+
+    struct Page
+    {
+        // pages with free chunks
+        Page* prev {nullptr};
+        Page* next {nullptr};
+        bool listed {false};
+
+        // all mapped pages
+        Page* prevMapped {nullptr};
+        Page* nextMapped {nullptr};
+
+        Chunk* freeChunk {nullptr};
+
+        // chunks in use and chunks which were ever handed out
+        std::size_t used {0};
+        std::size_t fresh {0};
+    };
+
+    static std::size_t RoundUp(std::size_t size)
+    {
+        if (size < sizeof(Chunk))
+            size = sizeof(Chunk);
+
+        return (size + alignment - 1) / alignment * alignment;
+    }
+
+    char* FirstChunk(Page* page) const
+    {
+        return reinterpret_cast<char*>(page) + RoundUp(sizeof(Page));
+    }
+
+    static Page* PageOf(void* ptr)
+    {
+        return reinterpret_cast<Page*>(reinterpret_cast<std::uintptr_t>(ptr) & ~(pageSize - 1));
+    }
+
+    bool MapPage()
+    {
+        if (mappedPages >= maxPages)
+            return false;
+
+        void* memory = Map();
+
+        if (memory == nullptr)
+            return false;
+
+        Page* page = new(memory) Page;
+
+        page->nextMapped = pages;
+
+        if (pages != nullptr)
+            pages->prevMapped = page;
+
+        pages = page;
+
+        mappedPages++;
+        emptyPages++;
+        m_totalSize += pageSize;
+
+        PushBack(page);
+
+        return true;
+    }
+
+    void UnmapPage(Page* page)
+    {
+        if (page->prevMapped != nullptr)
+            page->prevMapped->nextMapped = page->nextMapped;
+        else
+            pages = page->nextMapped;
+
+        if (page->nextMapped != nullptr)
+            page->nextMapped->prevMapped = page->prevMapped;
+
+        mappedPages--;
+        m_totalSize -= pageSize;
+
+        Unmap(page);
+    }
+
+    void PushFront(Page* page)
+    {
+        page->prev = nullptr;
+        page->next = available;
+
+        if (available != nullptr)
+            available->prev = page;
+        else
+            availableTail = page;
+
+        available = page;
+        page->listed = true;
+    }
+
+    void PushBack(Page* page)
+    {
+        page->prev = availableTail;
+        page->next = nullptr;
+
+        if (availableTail != nullptr)
+            availableTail->next = page;
+        else
+            available = page;
+
+        availableTail = page;
+        page->listed = true;
+    }
+
+    void Unlink(Page* page)
+    {
+        if (!page->listed)
+            return;
+
+        if (page->prev != nullptr)
+            page->prev->next = page->next;
+        else
+            available = page->next;
+
+        if (page->next != nullptr)
+            page->next->prev = page->prev;
+        else
+            availableTail = page->prev;
+
+        page->prev = nullptr;
+        page->next = nullptr;
+        page->listed = false;
+    }
+
+#if defined(__linux__)
+    // a mapping of two pages is cut to one aligned page
+    static void* Map()
+    {
+        void* memory = mmap(nullptr, 2*pageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if (memory == MAP_FAILED)
+            return nullptr;
+
+        const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(memory);
+        const std::uintptr_t aligned = (address + pageSize - 1) & ~(pageSize - 1);
+
+        if (aligned > address)
+            munmap(memory, aligned - address);
+
+        munmap(reinterpret_cast<void*>(aligned + pageSize), address + pageSize - aligned);
+
+#if defined(MADV_HUGEPAGE)
+        madvise(reinterpret_cast<void*>(aligned), pageSize, MADV_HUGEPAGE);
+#endif
+
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    static void Unmap(Page* page)
+    {
+        page->~Page();
+        munmap(page, pageSize);
+    }
+#else
+    static void* Map()
+    {
+        return ::operator new(pageSize, std::align_val_t(pageSize), std::nothrow);
+    }
+
+    static void Unmap(Page* page)
+    {
+        page->~Page();
+        ::operator delete(page, std::align_val_t(pageSize));
+    }
+#endif
+
+private:
+    std::size_t chunkSize {0};
+    std::size_t chunksPerPage {0};
+    std::size_t maxPages {0};
+
+    Page* pages {nullptr};
+    Page* available {nullptr};
+    Page* availableTail {nullptr};
+
+    std::size_t mappedPages {0};
+    std::size_t emptyPages {0};
+
+    // the least quantity of spare pages since the last window of trims
+    static const std::size_t trimWindow {64};
+    std::size_t lowEmptyPages {0};
+    std::size_t trims {0};
+};
+
+}
+
+#endif
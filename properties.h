@@ -11,7 +11,9 @@
 
 #include <map>
 #include <list>
-#include <wx/string.h>
+#include <string>
+
+#include "constants.h"
 
 namespace ProtoPuddle
 {
@@ -66,7 +68,7 @@ public:
         return *this;
     }
 
-    void GetNamesAsList(std::list<wxString> *names)
+    void GetNamesAsList(std::list<std::string> *names)
     {
         for (auto it=_properties.begin(); it!=_properties.end(); ++it)
         {
@@ -74,7 +76,7 @@ public:
         }
     }
 
-    bool IsExist(const wxString& name)
+    bool IsExist(const std::string& name)
     {
         if (_properties.find(name) == _properties.end())
             return false;
@@ -82,7 +84,7 @@ public:
         return true;
     }
 
-    void SetProperty(const wxString& name, const Property& property)
+    void SetProperty(const std::string& name, const Property& property)
     {
         if (IsExist(name))
         {
@@ -90,11 +92,11 @@ public:
         }
         else
         {
-            _properties.insert( std::pair<wxString,Property>(name,property) );
+            _properties.insert( std::pair<std::string,Property>(name,property) );
         }
     }
 
-    bool CheckValue(const wxString& name, int value)
+    bool CheckValue(const std::string& name, int value)
     {
         if (IsExist(name))
         {
@@ -107,7 +109,7 @@ public:
         return false;
     }
 
-    void SetValue(const wxString& name, int value)
+    void SetValue(const std::string& name, int value)
     {
         if (IsExist(name))
         {
@@ -120,7 +122,7 @@ public:
         }
     }
 
-    int GetValue(const wxString& name)
+    int GetValue(const std::string& name)
     {
         if (IsExist(name))
         {
@@ -130,7 +132,7 @@ public:
         return 0;
     }
 
-    void SetRange(const wxString& name, int min, int max)
+    void SetRange(const std::string& name, int min, int max)
     {
         if (IsExist(name))
         {
@@ -139,7 +141,7 @@ public:
         }
     }
 
-    int GetMin(const wxString& name)
+    int GetMin(const std::string& name)
     {
         if (IsExist(name))
         {
@@ -149,7 +151,7 @@ public:
         return 0;
     }
 
-    int GetMax(const wxString& name)
+    int GetMax(const std::string& name)
     {
         if (IsExist(name))
         {
@@ -165,27 +167,29 @@ public:
     }
 
 private:
-    std::map<wxString,Property> _properties {
-        { wxT("sortsOfCell"), Property(5,0,100) },
-        { wxT("cellEnergy"), Property(100,1,1000) },
-        { wxT("maxDamage"), Property(30,1,500) },
-        { wxT("behaviorGenes"), Property(1,1,10) },
-        { wxT("minEnergyForDivision"), Property(50,1,1000) },
-        { wxT("maxEnergyForDivision"), Property(100,1,1000) },
-        { wxT("plants"), Property(0,0,100) },
-        { wxT("plantEnergy"), Property(30,1,500) },
-        { wxT("meatEnergy"), Property(50,1,500) },
-        { wxT("maxAge"), Property(300,1,1000) },
-        { wxT("stepsPerSecond"), Property(5,1,60) },
-        { wxT("plantsPerStep"), Property(2,0,100) },
-        { wxT("worldWidth"), Property(20,4,80) },
-        { wxT("worldHeight"), Property(20,4,80) },
-        { wxT("plantLifeTime"), Property(20,1,1000) },
-        { wxT("meatLifeTime"), Property(20,1,1000) },
-        { wxT("movementEnergy"), Property(1,1,100) },
-        { wxT("attackEnergy"), Property(2,1,100) },
-        { wxT("attackCondition"), Property(10,1,500) },
-        { wxT("maxMutationProbability"), Property(50,0,100) }
+    std::map<std::string,Property> _properties {
+        { "sortsOfCell", Property(5,0,100) },
+        { "cellEnergy", Property(100,1,1000) },
+        { "maxDamage", Property(30,1,500) },
+        { "behaviorGenes", Property(1,1,10) },
+        { "minEnergyForDivision", Property(50,1,1000) },
+        { "maxEnergyForDivision", Property(100,1,1000) },
+        { "plants", Property(0,0,100) },
+        { "plantEnergy", Property(30,1,500) },
+        { "meatEnergy", Property(50,1,500) },
+        { "maxAge", Property(300,1,1000) },
+        { "stepsPerSecond", Property(5,1,60) },
+        { "plantsPerStep", Property(2,0,100) },
+        { "worldWidth", Property(20,4,maxWorldWidth) },
+        { "worldHeight", Property(20,4,maxWorldHeight) },
+        { "plantLifeTime", Property(20,1,1000) },
+        { "meatLifeTime", Property(20,1,1000) },
+        { "movementEnergy", Property(1,1,100) },
+        { "attackEnergy", Property(2,1,100) },
+        { "attackCondition", Property(10,1,500) },
+        { "maxMutationProbability", Property(50,0,100) },
+        { "updateOrder", Property(1,0,5) },
+        { "compactionInterval", Property(0,0,1000) }
     };
 };
 
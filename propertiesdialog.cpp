@@ -28,20 +28,20 @@ PrefsPageGeneralPanel::PrefsPageGeneralPanel(wxWindow *parent) : wxPanel(parent)
     worldWidthCtrl = new wxSpinCtrl(this, wxID_ANY);
     worldHeightCtrl = new wxSpinCtrl(this, wxID_ANY);
 
-    sortsOfCellCtrl->SetRange(properties.GetMin(wxString("sortsOfCell")),properties.GetMax(wxString("sortsOfCell")));
-    cellEnergyCtrl->SetRange(properties.GetMin(wxString("cellEnergy")),properties.GetMax(wxString("cellEnergy")));
-    maxDamageCtrl->SetRange(properties.GetMin(wxString("maxDamage")),properties.GetMax(wxString("maxDamage")));
-    //behaviorGenesCtrl->SetRange(properties.GetMin(wxString("behaviorGenes")),properties.GetMax(wxString("behaviorGenes")));
-    minEnergyForDivisionCtrl->SetRange(properties.GetMin(wxString("minEnergyForDivision")),properties.GetMax(wxString("minEnergyForDivision")));
-    maxEnergyForDivisionCtrl->SetRange(properties.GetMin(wxString("maxEnergyForDivision")),properties.GetMax(wxString("maxEnergyForDivision")));
-    plantsCtrl->SetRange(properties.GetMin(wxString("plants")),properties.GetMax(wxString("plants")));
-    plantEnergyCtrl->SetRange(properties.GetMin(wxString("plantEnergy")),properties.GetMax(wxString("plantEnergy")));
-    meatEnergyCtrl->SetRange(properties.GetMin(wxString("meatEnergy")),properties.GetMax(wxString("meatEnergy")));
-    maxAgeCtrl->SetRange(properties.GetMin(wxString("maxAge")),properties.GetMax(wxString("maxAge")));
-    stepsPerSecondCtrl->SetRange(properties.GetMin(wxString("stepsPerSecond")),properties.GetMax(wxString("stepsPerSecond")));
-    plantsPerStepCtrl->SetRange(properties.GetMin(wxString("plantsPerStep")),properties.GetMax(wxString("plantsPerStep")));
-    worldWidthCtrl->SetRange(properties.GetMin(wxString("worldWidth")),properties.GetMax(wxString("worldWidth")));
-    worldHeightCtrl->SetRange(properties.GetMin(wxString("worldHeight")),properties.GetMax(wxString("worldHeight")));
+    sortsOfCellCtrl->SetRange(properties.GetMin("sortsOfCell"),properties.GetMax("sortsOfCell"));
+    cellEnergyCtrl->SetRange(properties.GetMin("cellEnergy"),properties.GetMax("cellEnergy"));
+    maxDamageCtrl->SetRange(properties.GetMin("maxDamage"),properties.GetMax("maxDamage"));
+    //behaviorGenesCtrl->SetRange(properties.GetMin("behaviorGenes"),properties.GetMax("behaviorGenes"));
+    minEnergyForDivisionCtrl->SetRange(properties.GetMin("minEnergyForDivision"),properties.GetMax("minEnergyForDivision"));
+    maxEnergyForDivisionCtrl->SetRange(properties.GetMin("maxEnergyForDivision"),properties.GetMax("maxEnergyForDivision"));
+    plantsCtrl->SetRange(properties.GetMin("plants"),properties.GetMax("plants"));
+    plantEnergyCtrl->SetRange(properties.GetMin("plantEnergy"),properties.GetMax("plantEnergy"));
+    meatEnergyCtrl->SetRange(properties.GetMin("meatEnergy"),properties.GetMax("meatEnergy"));
+    maxAgeCtrl->SetRange(properties.GetMin("maxAge"),properties.GetMax("maxAge"));
+    stepsPerSecondCtrl->SetRange(properties.GetMin("stepsPerSecond"),properties.GetMax("stepsPerSecond"));
+    plantsPerStepCtrl->SetRange(properties.GetMin("plantsPerStep"),properties.GetMax("plantsPerStep"));
+    worldWidthCtrl->SetRange(properties.GetMin("worldWidth"),properties.GetMax("worldWidth"));
+    worldHeightCtrl->SetRange(properties.GetMin("worldHeight"),properties.GetMax("worldHeight"));
 
     sortsOfCellCtrl->Bind(wxEVT_SPINCTRL, &PrefsPageGeneralPanel::ChangedSortsOfCell, this);
     cellEnergyCtrl->Bind(wxEVT_SPINCTRL, &PrefsPageGeneralPanel::ChangedCellEnergy, this);
@@ -98,20 +98,20 @@ bool PrefsPageGeneralPanel::TransferDataToWindow()
 {
     properties = PropertiesSingleton::getInstance().GetProperties();
 
-    sortsOfCellCtrl->SetValue(properties.GetValue(wxString("sortsOfCell")));
-    cellEnergyCtrl->SetValue(properties.GetValue(wxString("cellEnergy")));
-    maxDamageCtrl->SetValue(properties.GetValue(wxString("maxDamage")));
-    //behaviorGenesCtrl->SetValue(properties.GetValue(wxString("behaviorGenes")));
-    minEnergyForDivisionCtrl->SetValue(properties.GetValue(wxString("minEnergyForDivision")));
-    maxEnergyForDivisionCtrl->SetValue(properties.GetValue(wxString("maxEnergyForDivision")));
-    plantsCtrl->SetValue(properties.GetValue(wxString("plants")));
-    plantEnergyCtrl->SetValue(properties.GetValue(wxString("plantEnergy")));
-    meatEnergyCtrl->SetValue(properties.GetValue(wxString("meatEnergy")));
-    maxAgeCtrl->SetValue(properties.GetValue(wxString("maxAge")));
-    stepsPerSecondCtrl->SetValue(properties.GetValue(wxString("stepsPerSecond")));
-    plantsPerStepCtrl->SetValue(properties.GetValue(wxString("plantsPerStep")));
-    worldWidthCtrl->SetValue(properties.GetValue(wxString("worldWidth")));
-    worldHeightCtrl->SetValue(properties.GetValue(wxString("worldHeight")));
+    sortsOfCellCtrl->SetValue(properties.GetValue("sortsOfCell"));
+    cellEnergyCtrl->SetValue(properties.GetValue("cellEnergy"));
+    maxDamageCtrl->SetValue(properties.GetValue("maxDamage"));
+    //behaviorGenesCtrl->SetValue(properties.GetValue("behaviorGenes"));
+    minEnergyForDivisionCtrl->SetValue(properties.GetValue("minEnergyForDivision"));
+    maxEnergyForDivisionCtrl->SetValue(properties.GetValue("maxEnergyForDivision"));
+    plantsCtrl->SetValue(properties.GetValue("plants"));
+    plantEnergyCtrl->SetValue(properties.GetValue("plantEnergy"));
+    meatEnergyCtrl->SetValue(properties.GetValue("meatEnergy"));
+    maxAgeCtrl->SetValue(properties.GetValue("maxAge"));
+    stepsPerSecondCtrl->SetValue(properties.GetValue("stepsPerSecond"));
+    plantsPerStepCtrl->SetValue(properties.GetValue("plantsPerStep"));
+    worldWidthCtrl->SetValue(properties.GetValue("worldWidth"));
+    worldHeightCtrl->SetValue(properties.GetValue("worldHeight"));
 
     return true;
 }
@@ -161,67 +161,67 @@ void PrefsPageGeneralPanel::UpdateSettingsIfNecessary()
 }
 
 void PrefsPageGeneralPanel::ChangedSortsOfCell(wxSpinEvent& e) {
-    properties.SetValue(wxString("sortsOfCell"), e.GetValue());
+    properties.SetValue("sortsOfCell", e.GetValue());
     UpdateSettingsIfNecessary();
 
     showAdvice = true;
 }
 void PrefsPageGeneralPanel::ChangedCellEnergy(wxSpinEvent& e) {
-    properties.SetValue(wxString("cellEnergy"), e.GetValue());
+    properties.SetValue("cellEnergy", e.GetValue());
     UpdateSettingsIfNecessary();
 }
 void PrefsPageGeneralPanel::ChangedMaxDamage(wxSpinEvent& e) {
-    properties.SetValue(wxString("maxDamage"), e.GetValue());
+    properties.SetValue("maxDamage", e.GetValue());
     UpdateSettingsIfNecessary();
 }
 /*
 void PrefsPageGeneralPanel::ChangedBehaviorGenes(wxSpinEvent& e) {
-    properties.SetValue(wxString("behaviorGenes"), e.GetValue());
+    properties.SetValue("behaviorGenes", e.GetValue());
     UpdateSettingsIfNecessary();
 }
 */
 void PrefsPageGeneralPanel::ChangedMinEnergyForDivision(wxSpinEvent& e) {
-    properties.SetValue(wxString("minEnergyForDivision"), e.GetValue());
+    properties.SetValue("minEnergyForDivision", e.GetValue());
     UpdateSettingsIfNecessary();
 }
 void PrefsPageGeneralPanel::ChangedMaxEnergyForDivision(wxSpinEvent& e) {
-    properties.SetValue(wxString("maxEnergyForDivision"), e.GetValue());
+    properties.SetValue("maxEnergyForDivision", e.GetValue());
     UpdateSettingsIfNecessary();
 }
 void PrefsPageGeneralPanel::ChangedPlants(wxSpinEvent& e) {
-    properties.SetValue(wxString("plants"), e.GetValue());
+    properties.SetValue("plants", e.GetValue());
     UpdateSettingsIfNecessary();
 
     showAdvice = true;
 }
 void PrefsPageGeneralPanel::ChangedPlantEnergy(wxSpinEvent& e) {
-    properties.SetValue(wxString("plantEnergy"), e.GetValue());
+    properties.SetValue("plantEnergy", e.GetValue());
     UpdateSettingsIfNecessary();
 }
 void PrefsPageGeneralPanel::ChangedMeatEnergy(wxSpinEvent& e) {
-    properties.SetValue(wxString("meatEnergy"), e.GetValue());
+    properties.SetValue("meatEnergy", e.GetValue());
     UpdateSettingsIfNecessary();
 }
 void PrefsPageGeneralPanel::ChangedMaxAge(wxSpinEvent& e) {
-    properties.SetValue(wxString("maxAge"), e.GetValue());
+    properties.SetValue("maxAge", e.GetValue());
     UpdateSettingsIfNecessary();
 }
 void PrefsPageGeneralPanel::ChangedStepsPerSecond(wxSpinEvent& e) {
-    properties.SetValue(wxString("stepsPerSecond"), e.GetValue());
+    properties.SetValue("stepsPerSecond", e.GetValue());
     UpdateSettingsIfNecessary();
 }
 void PrefsPageGeneralPanel::ChangedPlantsPerStep(wxSpinEvent& e) {
-    properties.SetValue(wxString("plantsPerStep"), e.GetValue());
+    properties.SetValue("plantsPerStep", e.GetValue());
     UpdateSettingsIfNecessary();
 }
 void PrefsPageGeneralPanel::ChangedWorldWidth(wxSpinEvent& e) {
-    properties.SetValue(wxString("worldWidth"), e.GetValue());
+    properties.SetValue("worldWidth", e.GetValue());
     UpdateSettingsIfNecessary();
 
     showAdvice = true;
 }
 void PrefsPageGeneralPanel::ChangedWorldHeight(wxSpinEvent& e) {
-    properties.SetValue(wxString("worldHeight"), e.GetValue());
+    properties.SetValue("worldHeight", e.GetValue());
     UpdateSettingsIfNecessary();
 
     showAdvice = true;
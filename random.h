@@ -1,6 +1,6 @@
 /////////////////////////////////////////////////////////////////////////////
 // Name:               random.h
-// Description:        ...
+// Description:        Counter-based random numbers
 // Author:             Alexey Orlov (https://github.com/m110h)
 // Last modification:  18/08/2020
 // Licence:            MIT licence
@@ -9,6 +9,74 @@
 #ifndef _RANDOM_H_
 #define _RANDOM_H_
 
-#include "thirdparty/random.hpp"
+#include <cstdint>
+
+namespace ProtoPuddle
+{
+
+// A stream of random numbers is keyed by the seed of a world, a step, a key
+// of an entity (e.g. its id) and a domain of draws. The n-th draw is a hash of
+// the key and n (SplitMix64), so a stream has no state to share: any stream
+// can be made again anywhere and draws don't depend on the order of threads.
+// It is a uniform random bit generator for <random> and <algorithm> too.
+class Random
+{
+public:
+    using result_type = std::uint64_t;
+
+    explicit Random(std::uint64_t seed = 0, std::uint64_t step = 0, std::uint64_t key = 0, std::uint64_t domain = 0)
+    {
+        state = Mix(Mix(Mix(seed + domain*gamma) ^ step) ^ key);
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return ~result_type(0); }
+
+    result_type operator()()
+    {
+        state += gamma;
+        return Mix(state);
+    }
+
+    // [0, n), a multiply-shift for ranges up to 2^32 and a remainder for
+    // bigger ones, the bias is negligible for the ranges of the world
+    std::uint64_t Below(std::uint64_t n)
+    {
+        const std::uint64_t x = (*this)();
+
+        if (n <= (std::uint64_t(1) << 32))
+            return ((x >> 32) * n) >> 32;
+
+        return x % n;
+    }
+
+    // [_min, _max]
+    int Get(int _min, int _max)
+    {
+        return _min + static_cast<int>(Below(static_cast<std::uint64_t>(static_cast<std::int64_t>(_max) - _min) + 1));
+    }
+
+    // true with the probability [0, 1]
+    bool Chance(float probability)
+    {
+        return static_cast<float>((*this)() >> 40) * (1.0f / 16777216.0f) < probability;
+    }
+
+    // the finalizer of SplitMix64
+    static std::uint64_t Mix(std::uint64_t x)
+    {
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+
+        return x ^ (x >> 31);
+    }
+
+private:
+    static const std::uint64_t gamma {0x9e3779b97f4a7c15ULL};
+
+    std::uint64_t state {0};
+};
+
+}
 
 #endif
@@ -0,0 +1,716 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:               runner.cpp
+// Description:        Headless batch runner of the simulation (protopuddle-run)
+// Author:             Alexey Orlov (https://github.com/m110h)
+// Last modification:  18/08/2020
+// Licence:            MIT licence
+/////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <algorithm>
+#include <cstdlib>
+
+#include "entities.h"
+#include "properties.h"
+#include "poolallocator.h"
+
+#include "thirdparty/allocator/freelistallocator.h"
+
+static void PrintUsage()
+{
+    std::cout << "Usage: protopuddle-run [options] [config.json]" << std::endl
+              << std::endl
+              << "Loads a configuration (the same format as File->Open of the GUI), creates a new world" << std::endl
+              << "and performs the given number of steps without any rendering and pacing." << std::endl
+              << std::endl
+              << "Options:" << std::endl
+              << "  -n, --steps <N>       quantity of steps (default: 1000)" << std::endl
+              << "  -r, --report <K>      print a progress line every K steps (default: 0, disabled)" << std::endl
+              << "  -o, --order <NAME>    update order: shuffle, random, permutation, sweep, checkerboard," << std::endl
+              << "                        synchronous" << std::endl
+              << "                        (default: the value of 'updateOrder' of the configuration)" << std::endl
+              << "  -s, --seed <N>        seed of the world (default: the value of 'seed' of the" << std::endl
+              << "                        configuration or the clock)" << std::endl
+              << "  --hash                print a hash of the state of the world at the end" << std::endl
+              << "  --expect-hash <H>     fail if the hash of the state at the end isn't H" << std::endl
+              << "  --census <K>          print K most numerous genotypes at the end (default: 0)" << std::endl
+              << "  --lineage <FILE>      write branching events of species to a binary log" << std::endl
+              << "  --lineage-cells       keep the descent of individual cells too" << std::endl
+              << "  --ancestry <K>        print ancestries of K living cells at the end (default: 0)" << std::endl
+              << "  -c, --compact <K>     reorder cells by their fields every K steps, 0 - never" << std::endl
+              << "                        (default: the value of 'compactionInterval' of the configuration)" << std::endl
+              << "  -t, --threads <N>     threads of a step, cells of distant tiles act at once (default: 1)" << std::endl
+              << "  --bench-order <N>     measure update orders over N entities and exit" << std::endl
+              << "  --bench-alloc <N>     measure allocators of blocks of cells under a churn of up" << std::endl
+              << "                        to N blocks, alone and mixed with small records, and exit" << std::endl
+              << "  --memory-dump <FILE>  write statistics of the allocator of cells as JSON at the end" << std::endl
+              << "  -h, --help            show this help" << std::endl;
+}
+
+static bool ParseNumber(const std::string& str, long long& value)
+{
+    char* end = nullptr;
+    value = std::strtoll(str.c_str(), &end, 10);
+
+    return (end != str.c_str()) && (*end == '\0') && (value >= 0);
+}
+
+// Entities are scattered over a square world filled by a half, every order
+// visits them several times, the result is time per visited entity. The
+// synchronous order isn't an order of visits: the scheduler gives it indices
+// as they are and its cost is the sense phase and the resolution of contests
+// in World::StepSynchronous, so it is left out of the comparison.
+static void BenchOrders(long long quantity)
+{
+    const int rounds = 20;
+    const int side = std::max(1, static_cast<int>(std::ceil(std::sqrt(2.0 * quantity))));
+
+    std::vector<ProtoPuddle::Point> positions(quantity);
+
+    std::mt19937 engine(1);
+
+    for (ProtoPuddle::Point& p: positions)
+    {
+        p = ProtoPuddle::Point(engine() % side, engine() % side);
+    }
+
+    std::cout << "entities " << quantity << ", world " << side << "x" << side << ", rounds " << rounds << std::endl;
+
+    for (int policy=0; policy<ProtoPuddle::Scheduler::ORDER_QUANTITY; policy++)
+    {
+        if (policy == ProtoPuddle::Scheduler::ORDER_SYNCHRONOUS)
+            continue;
+
+        ProtoPuddle::Scheduler scheduler;
+
+        scheduler.Reset(side, side);
+        scheduler.SetPolicy(policy);
+
+        long long checksum = 0;
+
+        auto start = std::chrono::steady_clock::now();
+
+        for (int i=0; i<rounds; i++)
+        {
+            scheduler.Run(positions.size(),
+                [&positions](std::uint32_t index) -> const ProtoPuddle::Point& {
+                    return positions[index];
+                },
+                [&positions, &checksum](std::uint32_t index) {
+                    checksum += positions[index].x;
+                });
+        }
+
+        auto finish = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(finish - start).count();
+
+        std::cout << std::left << std::setw(14) << ProtoPuddle::Scheduler::GetPolicyName(policy)
+                  << std::right << std::fixed << std::setprecision(2) << std::setw(8)
+                  << (quantity > 0 ? ns / (static_cast<double>(quantity) * rounds) : 0.0) << " ns/entity"
+                  << " (checksum " << checksum << ")" << std::endl;
+    }
+}
+
+// nonzero buckets of a histogram of walks, see mtrebi::Allocator::Statistics
+static void PrintWalks(const char* name, const std::size_t* walks)
+{
+    std::cout << "  " << name << " walks:";
+
+    for (std::size_t b=0; b<mtrebi::Allocator::Statistics::walkBuckets; b++)
+    {
+        if (walks[b] == 0)
+            continue;
+
+        const std::size_t low = b > 0 ? std::size_t(1) << (b-1) : 0;
+
+        std::cout << " " << low;
+
+        if (b+1 == mtrebi::Allocator::Statistics::walkBuckets)
+            std::cout << "+";
+        else if (b > 1)
+            std::cout << "-" << (std::size_t(1) << b) - 1;
+
+        std::cout << ":" << walks[b];
+    }
+
+    std::cout << std::endl;
+}
+
+static void PrintFreeBlocks(const mtrebi::Allocator::Statistics& statistics)
+{
+    std::cout << statistics.freeBlocks << " blocks of " << statistics.freeSize
+              << ", largest " << statistics.largestFreeBlock
+              << ", fragmentation " << std::fixed << std::setprecision(3) << statistics.GetFragmentation() << std::endl;
+}
+
+// A trace of blocks of several kinds: an operation allocates a block of a kind
+// or frees a random live block of it
+struct AllocationOp
+{
+    int kind;
+    long long block;
+};
+
+// Populations of kinds boom and crash: each follows a sine between a tenth and
+// all of its capacity, sines of kinds are shifted. An operation touches a kind
+// with a probability proportional to its capacity.
+static std::vector<AllocationOp> MakeChurn(const std::vector<std::size_t>& capacities, std::size_t operations)
+{
+    std::size_t total = 0;
+
+    for (std::size_t capacity: capacities)
+        total += capacity;
+
+    const double period = 8.0 * total;
+
+    std::vector<AllocationOp> trace;
+    trace.reserve(operations);
+
+    ProtoPuddle::Random random(1);
+    std::vector<std::size_t> live(capacities.size(), 0);
+
+    for (std::size_t i=0; i<operations; i++)
+    {
+        std::uint64_t pick = random.Below(total);
+        int kind = 0;
+
+        while (pick >= capacities[kind])
+            pick -= capacities[kind++];
+
+        const double phase = std::sin(6.283185307179586 * static_cast<double>(i) / period + 2.0*kind);
+        const std::size_t target = static_cast<std::size_t>(capacities[kind] * (0.55 + 0.45 * phase));
+
+        if (live[kind] < target || live[kind] == 0)
+        {
+            trace.push_back({kind, -1});
+            live[kind]++;
+        }
+        else
+        {
+            trace.push_back({kind, static_cast<long long>(random.Below(live[kind]))});
+            live[kind]--;
+        }
+    }
+
+    return trace;
+}
+
+// Blocks of a kind are taken from allocators[kind], all kinds may share one.
+// The trace is replayed twice and the second pass is timed, so memory which an
+// allocator keeps is already mapped. The pool is trimmed every 256 operations,
+// as the world trims it once a step.
+static void RunChurn(const char* name, const std::vector<AllocationOp>& trace, const std::vector<std::size_t>& sizes,
+                     const std::vector<mtrebi::Allocator*>& allocators, const std::vector<ProtoPuddle::PoolAllocator*>& pools)
+{
+    std::vector<std::vector<void*>> blocks(sizes.size());
+    std::size_t failures = 0;
+    double ns = 0;
+
+    for (mtrebi::Allocator* allocator: allocators)
+        allocator->Init();
+
+    for (int pass=0; pass<2; pass++)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        for (std::size_t i=0; i<trace.size(); i++)
+        {
+            const AllocationOp& op = trace[i];
+            std::vector<void*>& live = blocks[op.kind];
+
+            if (op.block < 0)
+            {
+                void* block = allocators[op.kind]->Allocate(sizes[op.kind], 8);
+
+                if (block == nullptr)
+                    failures++;
+
+                live.push_back(block);
+            }
+            else
+            {
+                allocators[op.kind]->Free(live[op.block]);
+                live[op.block] = live.back();
+                live.pop_back();
+            }
+
+            if ((i & 255) == 255)
+            {
+                for (ProtoPuddle::PoolAllocator* pool: pools)
+                    pool->Trim();
+            }
+        }
+
+        auto finish = std::chrono::steady_clock::now();
+        ns = std::chrono::duration<double, std::nano>(finish - start).count();
+
+        // blocks which are left by the first pass are freed before the second,
+        // from the last address, so the free list inserts them at its head
+        for (std::size_t kind=0; kind<blocks.size() && pass == 0; kind++)
+        {
+            std::sort(blocks[kind].begin(), blocks[kind].end(), std::greater<void*>());
+
+            for (void* block: blocks[kind])
+                allocators[kind]->Free(block);
+
+            blocks[kind].clear();
+        }
+    }
+
+    std::size_t peak = 0;
+    std::size_t total = 0;
+
+    for (std::size_t kind=0; kind<allocators.size(); kind++)
+    {
+        if (std::find(allocators.begin(), allocators.begin() + kind, allocators[kind]) != allocators.begin() + kind)
+            continue;
+
+        peak += allocators[kind]->GetPeak();
+        total += allocators[kind]->GetTotal();
+    }
+
+    std::cout << std::left << std::setw(14) << name
+              << std::right << std::fixed << std::setprecision(2) << std::setw(10)
+              << ns / static_cast<double>(trace.size()) << " ns/op"
+              << ", peak " << peak << " of " << total
+              << ", failures " << failures << std::endl;
+
+    // what is left after the trace, by allocators
+    for (std::size_t kind=0; kind<allocators.size(); kind++)
+    {
+        if (std::find(allocators.begin(), allocators.begin() + kind, allocators[kind]) != allocators.begin() + kind)
+            continue;
+
+        const mtrebi::Allocator::Statistics statistics = allocators[kind]->GetStatistics();
+
+        PrintWalks("allocate", statistics.allocateWalks);
+        PrintWalks("free", statistics.freeWalks);
+
+        std::cout << "  free: ";
+        PrintFreeBlocks(statistics);
+    }
+}
+
+// Both allocators replay the same traces; the result is time per operation.
+// The first trace is blocks of cells alone. The second one mixes them with
+// many more records of the size of the former objects of plants and meat (56
+// bytes on 64-bit systems), which the free list has to fit among blocks of
+// cells; the pools are segregated by kinds.
+static void BenchAllocators(long long quantity)
+{
+    const std::size_t capacity = static_cast<std::size_t>(std::max(1LL, quantity));
+    const std::size_t recordSize {56};
+
+    {
+        const std::vector<AllocationOp> trace = MakeChurn({ capacity }, 50 * capacity);
+        const std::vector<std::size_t> sizes { sizeof(ProtoPuddle::CellBlock) };
+
+        std::cout << "blocks " << capacity << " of " << sizeof(ProtoPuddle::CellBlock) << " bytes, operations " << trace.size() << std::endl;
+
+        // an allocation header and an alignment padding of each block
+        mtrebi::FreeListAllocator freeList((sizeof(ProtoPuddle::CellBlock) + 32) * capacity, mtrebi::FreeListAllocator::FIND_FIRST);
+        ProtoPuddle::PoolAllocator pool(sizeof(ProtoPuddle::CellBlock), capacity);
+
+        RunChurn("free list", trace, sizes, { &freeList }, {});
+        RunChurn("pool", trace, sizes, { &pool }, { &pool });
+    }
+
+    {
+        const std::size_t records = 16 * capacity;
+        const std::vector<AllocationOp> trace = MakeChurn({ capacity, records, records / 2 }, 20 * (capacity + records + records / 2));
+        const std::vector<std::size_t> sizes { sizeof(ProtoPuddle::CellBlock), recordSize, recordSize };
+
+        std::cout << "mixed: blocks " << capacity << " of " << sizeof(ProtoPuddle::CellBlock) << " bytes, plants "
+                  << records << " and meat " << records / 2 << " of " << recordSize << " bytes, operations " << trace.size() << std::endl;
+
+        mtrebi::FreeListAllocator freeList((sizeof(ProtoPuddle::CellBlock) + 32) * capacity + (recordSize + 32) * (records + records / 2), mtrebi::FreeListAllocator::FIND_FIRST);
+        ProtoPuddle::PoolAllocator cellPool(sizeof(ProtoPuddle::CellBlock), capacity);
+        ProtoPuddle::PoolAllocator plantPool(recordSize, records);
+        ProtoPuddle::PoolAllocator meatPool(recordSize, records / 2);
+
+        RunChurn("free list", trace, sizes, { &freeList, &freeList, &freeList }, {});
+        RunChurn("pools", trace, sizes, { &cellPool, &plantPool, &meatPool }, { &cellPool, &plantPool, &meatPool });
+    }
+}
+
+// genotypes are printed with their actions by situations: empty, other, same,
+// meat, plant, wall, weak, dead
+static void PrintCensus(const ProtoPuddle::World& world, long long quantity)
+{
+    const std::vector<int>& census = world.GetCensus();
+
+    std::vector<int> genotypes;
+
+    for (int g=0; g<static_cast<int>(census.size()); g++)
+    {
+        if (census[g] > 0)
+            genotypes.push_back(g);
+    }
+
+    std::stable_sort(genotypes.begin(), genotypes.end(), [&census](int a, int b) {
+        return census[a] > census[b];
+    });
+
+    std::cout << "genotypes:    " << genotypes.size() << std::endl;
+
+    for (std::size_t i=0; i<genotypes.size() && static_cast<long long>(i)<quantity; i++)
+    {
+        const ProtoPuddle::Gene::Code& code = ProtoPuddle::Genotype::Decode(static_cast<std::uint16_t>(genotypes[i]));
+
+        std::cout << std::setw(6) << genotypes[i] << std::setw(10) << census[genotypes[i]] << "  actions";
+
+        for (std::uint8_t action: code)
+            std::cout << " " << static_cast<int>(action);
+
+        std::cout << std::endl;
+    }
+}
+
+// the first K cells found in the grid, long ancestries are cut
+static void PrintAncestry(ProtoPuddle::World& world, long long quantity, bool byCells)
+{
+    const int maxDepth = 8;
+
+    std::vector<ProtoPuddle::LineageRecord> ancestry;
+    long long printed = 0;
+
+    for (int y=0; y<world.GetSize().GetHeight() && printed<quantity; y++)
+    {
+        for (int x=0; x<world.GetSize().GetWidth() && printed<quantity; x++)
+        {
+            ProtoPuddle::EntityView e = world.GetEntityByPosition(ProtoPuddle::Point(x,y));
+
+            if (!e || e.GetType() != ProtoPuddle::EntityView::TYPE_CELL)
+                continue;
+
+            if (!world.GetAncestry(e.GetHandle(), byCells, ancestry))
+                continue;
+
+            std::cout << "cell " << e.GetId() << (byCells ? ", cells:" : ", species:");
+
+            std::size_t depth = 0;
+            std::uint64_t skipped = 0;
+
+            for (const ProtoPuddle::LineageRecord& r: ancestry)
+            {
+                if (depth < maxDepth)
+                {
+                    std::cout << (depth ? " <- " : " ") << r.key << " (step " << r.step;
+
+                    if (r.locus != ProtoPuddle::LineageRecord::noLocus)
+                        std::cout << ", locus " << static_cast<int>(r.locus);
+
+                    std::cout << ")";
+                }
+
+                depth++;
+                skipped += r.skipped;
+            }
+
+            if (depth > maxDepth)
+                std::cout << " <- ... " << (depth - maxDepth) << " more";
+
+            std::cout << "; kept " << depth << ", skipped " << skipped << std::endl;
+
+            printed++;
+        }
+    }
+}
+
+static void PrintState(ProtoPuddle::World& world)
+{
+    auto [plants, meat, cells] = world.GetEntitiesQuantity();
+
+    std::cout << "step " << world.GetSteps()
+              << ": cells " << cells
+              << ", plants " << plants
+              << ", meat " << meat << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    long long steps = 1000;
+    long long report = 0;
+    long long census = 0;
+    long long ancestry = 0;
+    long long threads = 1;
+    long long seed = -1;
+    bool hash = false;
+    std::string expectedHash;
+
+    std::string lineageFile;
+    bool lineageCells = false;
+    std::string memoryDump;
+
+    int order = -1;
+    long long compaction = -1;
+
+    std::string configFile;
+
+    for (int i=1; i<argc; i++)
+    {
+        std::string arg(argv[i]);
+
+        if (arg == "-h" || arg == "--help")
+        {
+            PrintUsage();
+            return EXIT_SUCCESS;
+        }
+        else if ((arg == "-n" || arg == "--steps") && (i+1 < argc))
+        {
+            if (!ParseNumber(argv[++i], steps))
+            {
+                std::cerr << "Invalid quantity of steps: " << argv[i] << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if ((arg == "-r" || arg == "--report") && (i+1 < argc))
+        {
+            if (!ParseNumber(argv[++i], report))
+            {
+                std::cerr << "Invalid report interval: " << argv[i] << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if (arg == "--census" && (i+1 < argc))
+        {
+            if (!ParseNumber(argv[++i], census))
+            {
+                std::cerr << "Invalid quantity of genotypes: " << argv[i] << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if ((arg == "-t" || arg == "--threads") && (i+1 < argc))
+        {
+            if (!ParseNumber(argv[++i], threads) || threads < 1)
+            {
+                std::cerr << "Invalid quantity of threads: " << argv[i] << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if ((arg == "-c" || arg == "--compact") && (i+1 < argc))
+        {
+            if (!ParseNumber(argv[++i], compaction))
+            {
+                std::cerr << "Invalid compaction interval: " << argv[i] << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if ((arg == "-s" || arg == "--seed") && (i+1 < argc))
+        {
+            if (!ParseNumber(argv[++i], seed))
+            {
+                std::cerr << "Invalid seed: " << argv[i] << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if (arg == "--hash")
+        {
+            hash = true;
+        }
+        else if (arg == "--expect-hash" && (i+1 < argc))
+        {
+            expectedHash = argv[++i];
+        }
+        else if (arg == "--lineage" && (i+1 < argc))
+        {
+            lineageFile = argv[++i];
+        }
+        else if (arg == "--lineage-cells")
+        {
+            lineageCells = true;
+        }
+        else if (arg == "--memory-dump" && (i+1 < argc))
+        {
+            memoryDump = argv[++i];
+        }
+        else if (arg == "--ancestry" && (i+1 < argc))
+        {
+            if (!ParseNumber(argv[++i], ancestry))
+            {
+                std::cerr << "Invalid quantity of cells: " << argv[i] << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if (arg == "--bench-order" && (i+1 < argc))
+        {
+            long long quantity = 0;
+
+            if (!ParseNumber(argv[++i], quantity))
+            {
+                std::cerr << "Invalid quantity of entities: " << argv[i] << std::endl;
+                return EXIT_FAILURE;
+            }
+
+            BenchOrders(quantity);
+            return EXIT_SUCCESS;
+        }
+        else if (arg == "--bench-alloc" && (i+1 < argc))
+        {
+            long long quantity = 0;
+
+            if (!ParseNumber(argv[++i], quantity))
+            {
+                std::cerr << "Invalid quantity of blocks: " << argv[i] << std::endl;
+                return EXIT_FAILURE;
+            }
+
+            BenchAllocators(quantity);
+            return EXIT_SUCCESS;
+        }
+        else if ((arg == "-o" || arg == "--order") && (i+1 < argc))
+        {
+            order = ProtoPuddle::Scheduler::FindPolicy(argv[++i]);
+
+            if (order < 0)
+            {
+                std::cerr << "Unknown update order: " << argv[i] << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if (!arg.empty() && arg[0] != '-' && configFile.empty())
+        {
+            configFile = arg;
+        }
+        else
+        {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            PrintUsage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    ProtoPuddle::GlobalProperties properties;
+    ProtoPuddle::World world(&properties);
+
+    if (!configFile.empty())
+    {
+        auto [flag, error] = world.OpenFromFile(configFile);
+
+        if (!flag)
+        {
+            std::cerr << configFile << ": " << error << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (order >= 0)
+    {
+        properties.SetValue("updateOrder", order);
+    }
+
+    if (compaction >= 0)
+    {
+        if (compaction > properties.GetMax("compactionInterval"))
+        {
+            std::cerr << "The compaction interval is more than " << properties.GetMax("compactionInterval") << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        properties.SetValue("compactionInterval", static_cast<int>(compaction));
+    }
+
+    world.SetLineageOptions(lineageFile, lineageCells);
+    world.SetThreads(static_cast<int>(threads));
+
+    if (seed >= 0)
+    {
+        world.SetSeed(static_cast<std::uint64_t>(seed));
+    }
+
+    world.New();
+
+    std::cout << "world " << world.GetSize().GetWidth() << "x" << world.GetSize().GetHeight()
+              << ", steps " << steps
+              << ", order " << ProtoPuddle::Scheduler::GetPolicyName(world.GetParams().updateOrder)
+              << ", threads " << world.GetThreads()
+              << ", seed " << world.GetSeed() << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (long long i=0; i<steps; i++)
+    {
+        world.Step();
+
+        if (report > 0 && (i+1) % report == 0)
+        {
+            PrintState(world);
+        }
+    }
+
+    auto finish = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(finish - start).count();
+
+    auto [plants, meat, cells] = world.GetEntitiesQuantity();
+    auto [total, used, peak] = world.GetMemoryInfo();
+    auto [resident, reserved] = world.GetMemoryPages();
+
+    std::cout << "---" << std::endl
+              << "steps:        " << steps << std::endl
+              << "time (s):     " << std::fixed << std::setprecision(3) << seconds << std::endl
+              << "steps/sec:    " << std::fixed << std::setprecision(1) << (seconds > 0.0 ? steps / seconds : 0.0) << std::endl
+              << "cells:        " << cells << std::endl
+              << "plants:       " << plants << std::endl
+              << "meat:         " << meat << std::endl
+              << "species:      " << world.GetSpecies().GetQuantity() << std::endl
+              << "top id:       " << world.GetTopId() << std::endl
+              << "memory total: " << total << std::endl
+              << "memory used:  " << used << std::endl
+              << "memory peak:  " << peak << std::endl
+              << "memory pages: " << resident << " resident of " << reserved << " reserved" << std::endl;
+
+    const mtrebi::Allocator::Statistics memory = world.GetMemoryStatistics();
+
+    std::cout << "memory calls: " << memory.allocations << " allocations, " << memory.frees << " frees, "
+              << memory.failures << " failures" << std::endl
+              << "memory free:  ";
+
+    PrintFreeBlocks(memory);
+
+    if (!memoryDump.empty() && !world.SaveMemoryStatistics(memoryDump))
+    {
+        std::cerr << "Can't write memory statistics to " << memoryDump << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    auto [speciesNodes, cellNodes, events] = world.GetLineageInfo();
+
+    std::cout << "lineage:      " << speciesNodes << " species nodes, " << cellNodes << " cell nodes, " << events << " events" << std::endl;
+
+    // the state is hashed after the run, so the measured time isn't changed
+    if (hash || !expectedHash.empty())
+    {
+        std::ostringstream stateHash;
+        stateHash << std::hex << std::setw(16) << std::setfill('0') << world.GetStateHash();
+
+        std::cout << "state hash:   " << stateHash.str() << std::endl;
+
+        if (!expectedHash.empty() && expectedHash != stateHash.str())
+        {
+            std::cerr << "The state hash differs from the expected one " << expectedHash << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (census > 0)
+    {
+        PrintCensus(world, census);
+    }
+
+    if (ancestry > 0)
+    {
+        PrintAncestry(world, ancestry, false);
+
+        if (lineageCells)
+            PrintAncestry(world, ancestry, true);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,392 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:               scheduler.h
+// Description:        Order in which entities act during a step
+// Author:             Alexey Orlov (https://github.com/m110h)
+// Last modification:  18/08/2020
+// Licence:            MIT licence
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _SCHEDULER_H_
+#define _SCHEDULER_H_
+
+#include <vector>
+#include <string>
+#include <array>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+#include "random.h"
+
+namespace ProtoPuddle
+{
+
+// Policies of the update order (value of the "updateOrder" property):
+//
+//   ORDER_SHUFFLE      - a shuffle with the same seed on every step, like the
+//                        first versions
+//   ORDER_RANDOM       - a shuffle with a persistent engine, a new random
+//                        permutation on every step
+//   ORDER_PERMUTATION  - random permutation without a buffer: indices go
+//                        through a Feistel network with new round keys on
+//                        every step, values outside of the list are walked
+//                        through the network again (cycle walking)
+//   ORDER_SWEEP        - row by row, from the top left corner
+//   ORDER_CHECKERBOARD - "black" fields (x+y is even) first, then "white"
+//                        ones, neighbours in four directions never act in
+//                        the same half of a step
+//   ORDER_SYNCHRONOUS  - all cells decide on the same state of the world and
+//                        then act, contested fields are resolved by hashes
+//                        (see World::StepSynchronous); the scheduler gives
+//                        the sequence of indices
+class Scheduler
+{
+public:
+    enum
+    {
+        ORDER_SHUFFLE = 0,
+        ORDER_RANDOM,
+        ORDER_PERMUTATION,
+        ORDER_SWEEP,
+        ORDER_CHECKERBOARD,
+        ORDER_SYNCHRONOUS,
+        ORDER_QUANTITY
+    };
+
+    Scheduler()
+    {
+        Seed(static_cast<std::uint64_t>(std::chrono::system_clock::now().time_since_epoch().count()));
+    }
+
+    Scheduler(const Scheduler& src) = delete;
+    Scheduler& operator=(const Scheduler& r) = delete;
+
+    ~Scheduler() {}
+
+    static const char* GetPolicyName(int policy)
+    {
+        static const std::array<const char*, ORDER_QUANTITY> names {
+            "shuffle", "random", "permutation", "sweep", "checkerboard", "synchronous"
+        };
+
+        if (policy < 0 || policy >= ORDER_QUANTITY)
+            return "unknown";
+
+        return names[policy];
+    }
+
+    // returns -1 if there isn't such policy
+    static int FindPolicy(const std::string& name)
+    {
+        for (int i=0; i<ORDER_QUANTITY; i++)
+        {
+            if (name == GetPolicyName(i))
+                return i;
+        }
+
+        return -1;
+    }
+
+    // orders of all steps follow from the seed
+    void Seed(std::uint64_t seed)
+    {
+        shuffleSeed = seed;
+        engine = Random(seed);
+    }
+
+    void SetPolicy(int _policy)
+    {
+        if (_policy >= 0 && _policy < ORDER_QUANTITY)
+            policy = _policy;
+    }
+
+    int GetPolicy() const
+    {
+        return policy;
+    }
+
+    // the size of the world is needed by the sweep order only
+    void Reset(int _width, int _height)
+    {
+        width = _width;
+        height = _height;
+
+        order.clear();
+        buffer.clear();
+    }
+
+    // Calls f(index) for every index of [0, n) in the order of the policy,
+    // position(index) returns a position of an entity. New entities may be
+    // appended while f is called, they will act from the next step. Entities
+    // mustn't be removed or reordered.
+    template <class P, class F>
+    void Run(std::size_t n, P position, F f)
+    {
+        if (n == 0)
+            return;
+
+        if (policy == ORDER_PERMUTATION)
+        {
+            NewKeys(n);
+
+            for (std::size_t i=0; i<n; i++)
+            {
+                std::uint64_t index = Permute(i);
+
+                while (index >= n)
+                    index = Permute(index);
+
+                f(static_cast<std::uint32_t>(index));
+            }
+
+            return;
+        }
+
+        Order(n, position);
+
+        for (std::uint32_t index: order)
+        {
+            f(index);
+        }
+    }
+
+    // Tiles of 2^tileShift x 2^tileShift fields are coloured by parities of
+    // their coordinates, so tiles of one colour are a tile apart. If an entity
+    // reaches only its own and neighbour fields and tiles are two fields wide
+    // at least, entities of different tiles of a colour never touch the same
+    // field and tiles of a colour may be run at once. Indices are grouped by
+    // tiles, the order of the policy is kept inside a tile.
+    template <class P>
+    void Partition(std::size_t n, P position, int tileShift)
+    {
+        const int tilesX = ((width - 1) >> tileShift) + 1;
+        const int tilesY = ((height - 1) >> tileShift) + 1;
+
+        halfTilesX = static_cast<std::size_t>(tilesX + 1) / 2;
+        tilesPerColour = halfTilesX * ((tilesY + 1) / 2);
+
+        auto tile = [&](std::uint32_t index) -> std::size_t {
+            const auto& p = position(index);
+            const int tx = p.x >> tileShift;
+            const int ty = p.y >> tileShift;
+
+            return (((ty & 1) << 1) | (tx & 1))*tilesPerColour + (ty >> 1)*halfTilesX + (tx >> 1);
+        };
+
+        if (policy == ORDER_PERMUTATION)
+        {
+            NewKeys(n);
+            order.resize(n);
+
+            for (std::size_t i=0; i<n; i++)
+            {
+                std::uint64_t index = Permute(i);
+
+                while (index >= n)
+                    index = Permute(index);
+
+                order[i] = static_cast<std::uint32_t>(index);
+            }
+        }
+        else
+        {
+            Order(n, position);
+        }
+
+        // a stable counting sort by tiles
+        tileStarts.assign(colours*tilesPerColour + 1, 0);
+
+        for (std::uint32_t index: order)
+            tileStarts[tile(index) + 1]++;
+
+        for (std::size_t t=0; t<colours*tilesPerColour; t++)
+            tileStarts[t + 1] += tileStarts[t];
+
+        buffer.resize(n);
+        counts.assign(tileStarts.begin(), tileStarts.end() - 1);
+
+        for (std::uint32_t index: order)
+            buffer[counts[tile(index)]++] = index;
+    }
+
+    // tiles of a colour after Partition
+    std::size_t GetTilesQuantity() const
+    {
+        return tilesPerColour;
+    }
+
+    // calls f(index) for indices of a tile of a colour after Partition
+    template <class F>
+    void RunTile(int colour, std::size_t tile, F f) const
+    {
+        const std::size_t t = colour*tilesPerColour + tile;
+
+        for (std::size_t i=tileStarts[t]; i<tileStarts[t + 1]; i++)
+        {
+            f(buffer[i]);
+        }
+    }
+
+    static const int colours {4};
+
+private:
+    static const int rounds {4};
+
+    // the permutation is walked without a buffer, it isn't here
+    template <class P>
+    void Order(std::size_t n, P position)
+    {
+        switch (policy)
+        {
+        case ORDER_SHUFFLE:
+        {
+            Random random(shuffleSeed);
+
+            Sequence(n);
+            Shuffle(random);
+            break;
+        }
+        case ORDER_RANDOM:
+            Sequence(n);
+            Shuffle(engine);
+            break;
+        case ORDER_SWEEP:
+            Sweep(n, position);
+            break;
+        case ORDER_CHECKERBOARD:
+            Checkerboard(n, position);
+            break;
+        default:
+            Sequence(n);
+            break;
+        }
+    }
+
+    void Sequence(std::size_t n)
+    {
+        order.resize(n);
+
+        for (std::size_t i=0; i<n; i++)
+            order[i] = static_cast<std::uint32_t>(i);
+    }
+
+    // Fisher-Yates with the counter-based generator: std::shuffle and engines
+    // of the standard library differ between implementations, so the same
+    // seed would give different orders
+    void Shuffle(Random& random)
+    {
+        for (std::size_t i=order.size(); i>1; i--)
+        {
+            std::swap(order[i - 1], order[random.Below(i)]);
+        }
+    }
+
+    // stable counting sort by x and then by y, O(n + width + height)
+    template <class P>
+    void Sweep(std::size_t n, P position)
+    {
+        buffer.resize(n);
+        order.resize(n);
+
+        counts.assign(static_cast<std::size_t>(width) + 1, 0);
+
+        for (std::size_t i=0; i<n; i++)
+            counts[position(i).x + 1]++;
+
+        for (int x=0; x<width; x++)
+            counts[x + 1] += counts[x];
+
+        for (std::size_t i=0; i<n; i++)
+            buffer[counts[position(i).x]++] = static_cast<std::uint32_t>(i);
+
+        counts.assign(static_cast<std::size_t>(height) + 1, 0);
+
+        for (std::size_t i=0; i<n; i++)
+            counts[position(buffer[i]).y + 1]++;
+
+        for (int y=0; y<height; y++)
+            counts[y + 1] += counts[y];
+
+        for (std::size_t i=0; i<n; i++)
+            order[counts[position(buffer[i]).y]++] = buffer[i];
+    }
+
+    template <class P>
+    void Checkerboard(std::size_t n, P position)
+    {
+        order.clear();
+
+        for (int parity=0; parity<2; parity++)
+        {
+            for (std::size_t i=0; i<n; i++)
+            {
+                const auto& p = position(i);
+
+                if (((p.x + p.y) & 1) == parity)
+                    order.push_back(static_cast<std::uint32_t>(i));
+            }
+        }
+    }
+
+    // the domain of the network is [0, 4^halfBits), it is at most 4n, so
+    // cycle walking needs less than four rounds of the network on average
+    void NewKeys(std::size_t n)
+    {
+        halfBits = 1;
+
+        while ((std::uint64_t(1) << (2*halfBits)) < n)
+            halfBits++;
+
+        halfMask = (std::uint64_t(1) << halfBits) - 1;
+
+        for (std::uint64_t& key: keys)
+            key = engine();
+    }
+
+    std::uint64_t Permute(std::uint64_t x) const
+    {
+        std::uint64_t left = x >> halfBits;
+        std::uint64_t right = x & halfMask;
+
+        for (int i=0; i<rounds; i++)
+        {
+            std::uint64_t tmp = left ^ Round(right, keys[i]);
+            left = right;
+            right = tmp;
+        }
+
+        return (left << halfBits) | right;
+    }
+
+    // multiplicative hashing, the high bits of a product are mixed best
+    std::uint64_t Round(std::uint64_t x, std::uint64_t key) const
+    {
+        return (((x + key) * 0x9e3779b97f4a7c15ULL) ^ key) >> (64 - halfBits);
+    }
+
+private:
+    int policy {ORDER_RANDOM};
+
+    int width {0};
+    int height {0};
+
+    std::uint64_t shuffleSeed {0};
+    Random engine;
+
+    int halfBits {1};
+    std::uint64_t halfMask {1};
+    std::array<std::uint64_t, rounds> keys {};
+
+    std::vector<std::uint32_t> order;
+    std::vector<std::uint32_t> buffer;
+    std::vector<std::size_t> counts;
+
+    std::size_t halfTilesX {0};
+    std::size_t tilesPerColour {0};
+    std::vector<std::size_t> tileStarts;
+};
+
+}
+
+#endif
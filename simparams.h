@@ -0,0 +1,98 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:               simparams.h
+// Description:        Snapshot of simulation parameters for the step code
+// Author:             Alexey Orlov (https://github.com/m110h)
+// Last modification:  18/08/2020
+// Licence:            MIT licence
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _SIM_PARAMS_H_
+#define _SIM_PARAMS_H_
+
+#include <vector>
+
+#include "properties.h"
+
+namespace ProtoPuddle
+{
+
+// GlobalProperties is a map with string keys, it is good for dialogs and
+// configuration files, but too slow for the step code. The world compiles
+// the properties into this struct (World::New, World::ApplyProperties) and
+// entities read the plain fields.
+struct SimParams
+{
+    struct Field
+    {
+        const char* name;
+        int SimParams::*value;
+
+        // optional fields were added later, old configuration files don't have them
+        bool optional;
+    };
+
+    static const std::vector<Field>& GetFields()
+    {
+        static const std::vector<Field> fields {
+            { "sortsOfCell", &SimParams::sortsOfCell, false },
+            { "cellEnergy", &SimParams::cellEnergy, false },
+            { "maxDamage", &SimParams::maxDamage, false },
+            { "behaviorGenes", &SimParams::behaviorGenes, false },
+            { "minEnergyForDivision", &SimParams::minEnergyForDivision, false },
+            { "maxEnergyForDivision", &SimParams::maxEnergyForDivision, false },
+            { "plants", &SimParams::plants, false },
+            { "plantEnergy", &SimParams::plantEnergy, false },
+            { "meatEnergy", &SimParams::meatEnergy, false },
+            { "maxAge", &SimParams::maxAge, false },
+            { "stepsPerSecond", &SimParams::stepsPerSecond, false },
+            { "plantsPerStep", &SimParams::plantsPerStep, false },
+            { "worldWidth", &SimParams::worldWidth, false },
+            { "worldHeight", &SimParams::worldHeight, false },
+            { "plantLifeTime", &SimParams::plantLifeTime, false },
+            { "meatLifeTime", &SimParams::meatLifeTime, false },
+            { "movementEnergy", &SimParams::movementEnergy, false },
+            { "attackEnergy", &SimParams::attackEnergy, false },
+            { "attackCondition", &SimParams::attackCondition, false },
+            { "maxMutationProbability", &SimParams::maxMutationProbability, false },
+            { "updateOrder", &SimParams::updateOrder, true },
+            { "compactionInterval", &SimParams::compactionInterval, true }
+        };
+
+        return fields;
+    }
+
+    void Compile(GlobalProperties& properties)
+    {
+        for (const Field& field: GetFields())
+        {
+            this->*(field.value) = properties.GetValue(field.name);
+        }
+    }
+
+    int sortsOfCell {0};
+    int cellEnergy {0};
+    int maxDamage {0};
+    int behaviorGenes {0};
+    int minEnergyForDivision {0};
+    int maxEnergyForDivision {0};
+    int plants {0};
+    int plantEnergy {0};
+    int meatEnergy {0};
+    int maxAge {0};
+    int stepsPerSecond {0};
+    int plantsPerStep {0};
+    int worldWidth {0};
+    int worldHeight {0};
+    int plantLifeTime {0};
+    int meatLifeTime {0};
+    int movementEnergy {0};
+    int attackEnergy {0};
+    int attackCondition {0};
+    int maxMutationProbability {0};
+    int updateOrder {0};
+    int compactionInterval {0};
+};
+
+}
+
+#endif
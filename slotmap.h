@@ -0,0 +1,150 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:               slotmap.h
+// Description:        Table of entities addressed by generational handles
+// Author:             Alexey Orlov (https://github.com/m110h)
+// Last modification:  18/08/2020
+// Licence:            MIT licence
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _SLOT_MAP_H_
+#define _SLOT_MAP_H_
+
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <cstddef>
+
+namespace ProtoPuddle
+{
+
+// A handle is an index of a slot and a generation of the slot. The
+// generation grows every time the slot is taken and freed, it is odd while
+// the slot holds an item: a handle of a removed item never resolves to
+// another item which got the same slot later, nor to a free slot.
+struct Handle
+{
+    static const std::uint32_t invalidIndex {std::numeric_limits<std::uint32_t>::max()};
+
+    std::uint32_t index {invalidIndex};
+    std::uint32_t generation {0};
+
+    Handle() {}
+    Handle(std::uint32_t _index, std::uint32_t _generation): index(_index), generation(_generation) {}
+
+    bool IsValid() const { return index != invalidIndex; }
+
+    bool operator==(const Handle& r) const { return index == r.index && generation == r.generation; }
+    bool operator!=(const Handle& r) const { return !(*this == r); }
+};
+
+// Items are small values (e.g. references into stores of entities), they
+// may be changed through Get when an item moves. Freed slots are reused in
+// LIFO order through a list threaded over the slots.
+template <class T>
+class SlotMap
+{
+public:
+    SlotMap() {}
+
+    SlotMap(const SlotMap& src) = delete;
+    SlotMap& operator=(const SlotMap& r) = delete;
+
+    ~SlotMap() {}
+
+    void Clear()
+    {
+        slots.clear();
+        freeSlot = Handle::invalidIndex;
+        quantity = 0;
+    }
+
+    Handle Insert(const T& item)
+    {
+        std::uint32_t index = freeSlot;
+
+        if (index != Handle::invalidIndex)
+        {
+            freeSlot = slots[index].nextFree;
+        }
+        else
+        {
+            index = static_cast<std::uint32_t>(slots.size());
+            slots.emplace_back();
+        }
+
+        slots[index].item = item;
+        slots[index].generation++;
+        slots[index].nextFree = Handle::invalidIndex;
+
+        quantity++;
+
+        return Handle(index, slots[index].generation);
+    }
+
+    void Remove(const Handle& handle)
+    {
+        if (Get(handle) == nullptr)
+            return;
+
+        Slot& slot = slots[handle.index];
+
+        slot.item = T();
+        slot.generation++;
+        slot.nextFree = freeSlot;
+
+        freeSlot = handle.index;
+        quantity--;
+    }
+
+    // returns nullptr for a stale or an invalid handle and for a free slot
+    T* Get(const Handle& handle)
+    {
+        if (handle.index >= slots.size())
+            return nullptr;
+
+        Slot& slot = slots[handle.index];
+
+        if (slot.generation != handle.generation || (slot.generation & 1) == 0)
+            return nullptr;
+
+        return &slot.item;
+    }
+
+    const T* Get(const Handle& handle) const
+    {
+        return const_cast<SlotMap*>(this)->Get(handle);
+    }
+
+    // a handle of the current item of the slot, it resolves to nothing if the
+    // slot is free
+    Handle GetHandle(std::uint32_t index) const
+    {
+        return Handle(index, slots[index].generation);
+    }
+
+    std::size_t GetQuantity() const
+    {
+        return quantity;
+    }
+
+    std::size_t GetMemoryUsage() const
+    {
+        return slots.capacity()*sizeof(Slot);
+    }
+
+private:
+    struct Slot
+    {
+        T item {};
+        std::uint32_t generation {0};
+        std::uint32_t nextFree {Handle::invalidIndex};
+    };
+
+    std::vector<Slot> slots;
+    std::uint32_t freeSlot {Handle::invalidIndex};
+    std::size_t quantity {0};
+};
+
+}
+
+#endif
@@ -0,0 +1,164 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:               species.h
+// Description:        Registry of species of cells
+// Author:             Alexey Orlov (https://github.com/m110h)
+// Last modification:  18/08/2020
+// Licence:            MIT licence
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _SPECIES_H_
+#define _SPECIES_H_
+
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <cstddef>
+
+#include "types.h"
+
+namespace ProtoPuddle
+{
+
+struct Species
+{
+    static const std::uint32_t noParent {std::numeric_limits<std::uint32_t>::max()};
+
+    Color color {Color(0,0,0)};
+
+    // an index in the names of genes of the world
+    std::uint16_t geneName {0};
+
+    int foundingStep {0};
+    std::uint32_t parent {noParent};
+
+    // ids are reused, serial numbers are not; a serial number is the key of
+    // the species in its lineage
+    std::uint32_t serial {0};
+    std::uint32_t lineage {0};
+
+    // totals of live members
+    int population {0};
+    long long energy {0};
+};
+
+// A species is founded by every initial sort of cells and by every mutation,
+// cells of the same species are kin. The record lives while the species has
+// members, then its id is given to a next species; so a parent id may refer
+// to a newer species, it is the same one only if it was founded earlier.
+class SpeciesRegistry
+{
+public:
+    SpeciesRegistry() {}
+
+    SpeciesRegistry(const SpeciesRegistry& src) = delete;
+    SpeciesRegistry& operator=(const SpeciesRegistry& r) = delete;
+
+    ~SpeciesRegistry() {}
+
+    void Clear()
+    {
+        species.clear();
+        freeIds.clear();
+
+        nextSerial = 0;
+    }
+
+    // a new species has no members
+    std::uint32_t Found(const Color& color, std::uint16_t geneName, int step, std::uint32_t parent)
+    {
+        std::uint32_t id = 0;
+
+        if (!freeIds.empty())
+        {
+            id = freeIds.back();
+            freeIds.pop_back();
+        }
+        else
+        {
+            id = static_cast<std::uint32_t>(species.size());
+            species.emplace_back();
+
+            // there are no more free ids than records, so RemoveMember
+            // doesn't allocate
+            freeIds.reserve(species.capacity());
+        }
+
+        Species& s = species[id];
+
+        s.color = color;
+        s.geneName = geneName;
+        s.foundingStep = step;
+        s.parent = parent;
+        s.population = 0;
+        s.energy = 0;
+
+        s.serial = nextSerial++;
+        s.lineage = 0;
+
+        return id;
+    }
+
+    void SetLineage(std::uint32_t id, std::uint32_t lineage)
+    {
+        species[id].lineage = lineage;
+    }
+
+    void AddMember(std::uint32_t id, int energy)
+    {
+        species[id].population++;
+        species[id].energy += energy;
+    }
+
+    // returns true if the species died out, its record is valid till the
+    // next Found
+    bool RemoveMember(std::uint32_t id, int energy)
+    {
+        Species& s = species[id];
+
+        s.population--;
+        s.energy -= energy;
+
+        if (s.population > 0)
+            return false;
+
+        freeIds.push_back(id);
+
+        return true;
+    }
+
+    void AddEnergy(std::uint32_t id, int delta)
+    {
+        species[id].energy += delta;
+    }
+
+    const Species& Get(std::uint32_t id) const
+    {
+        return species[id];
+    }
+
+    // ids are [0, GetCapacity()), extinct species have no population
+    std::size_t GetCapacity() const
+    {
+        return species.size();
+    }
+
+    std::size_t GetQuantity() const
+    {
+        return species.size() - freeIds.size();
+    }
+
+    std::size_t GetMemoryUsage() const
+    {
+        return species.capacity()*sizeof(Species) + freeIds.capacity()*sizeof(std::uint32_t);
+    }
+
+private:
+    std::vector<Species> species;
+    std::vector<std::uint32_t> freeIds;
+
+    std::uint32_t nextSerial {0};
+};
+
+}
+
+#endif
@@ -31,4 +31,30 @@ std::size_t Allocator::GetTotal()
     return m_totalSize;
 }
 
+Allocator::Statistics Allocator::GetStatistics()
+{
+    return m_statistics;
+}
+
+double Allocator::Statistics::GetFragmentation() const
+{
+    if (freeSize == 0)
+        return 0.0;
+
+    return 1.0 - static_cast<double>(largestFreeBlock) / static_cast<double>(freeSize);
+}
+
+void Allocator::Statistics::CountWalk(std::size_t* walks, std::size_t length)
+{
+    std::size_t bucket = 0;
+
+    while (length > 0 && bucket+1 < walkBuckets)
+    {
+        length >>= 1;
+        bucket++;
+    }
+
+    walks[bucket]++;
+}
+
 }
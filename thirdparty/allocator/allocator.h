@@ -17,6 +17,32 @@ namespace mtrebi
 
 class Allocator {
 public:
+    // Counters since Init or Reset and a picture of free memory. A walk is
+    // the quantity of free list nodes visited by one call, walks are counted
+    // by powers of two: bucket 0 holds walks of 0 nodes, bucket b of
+    // [2^(b-1), 2^b) nodes, the last one all longer walks.
+    struct Statistics
+    {
+        static const std::size_t walkBuckets {20};
+
+        std::size_t allocations {0};
+        std::size_t frees {0};
+        std::size_t failures {0};
+
+        std::size_t allocateWalks[walkBuckets] {};
+        std::size_t freeWalks[walkBuckets] {};
+
+        std::size_t freeBlocks {0};
+        std::size_t freeSize {0};
+        std::size_t largestFreeBlock {0};
+
+        // external fragmentation: 0 when free memory is one block, near 1
+        // when it is scattered in small ones
+        double GetFragmentation() const;
+
+        static void CountWalk(std::size_t* walks, std::size_t length);
+    };
+
     explicit Allocator(const std::size_t totalSize);
 
     virtual ~Allocator();
@@ -30,10 +56,15 @@ public:
     std::size_t GetPeak();
     std::size_t GetTotal();
 
+    // counters with free blocks filled by an allocator
+    virtual Statistics GetStatistics();
+
 protected:
     std::size_t m_totalSize;
     std::size_t m_used;
     std::size_t m_peak;
+
+    Statistics m_statistics;
 };
 
 }
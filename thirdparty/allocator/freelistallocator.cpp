@@ -45,9 +45,9 @@ void FreeListAllocator::Init()
 
 void* FreeListAllocator::Allocate(const std::size_t size, const std::size_t alignment)
 {
-    wxASSERT_MSG(m_start_ptr, wxT("FreeListAllocator::Allocate: allocator isn't initialized, m_start_ptr is NULL"));
-    wxASSERT_MSG((size > sizeof(Node)), wxT("FreeListAllocator::Allocate: Allocation size must be bigger"));
-    wxASSERT_MSG((alignment >= 8), wxT("FreeListAllocator::Allocate: Alignment must be 8 at least"));
+    assert(m_start_ptr && "FreeListAllocator::Allocate: allocator isn't initialized, m_start_ptr is NULL");
+    assert((size > sizeof(Node)) && "FreeListAllocator::Allocate: Allocation size must be bigger");
+    assert((alignment >= 8) && "FreeListAllocator::Allocate: Alignment must be 8 at least");
 
     const std::size_t allocationHeaderSize = sizeof(FreeListAllocator::AllocationHeader);
 
@@ -66,17 +66,22 @@ void* FreeListAllocator::Allocate(const std::size_t size, const std::size_t alig
 
     //assert (affectedNode != nullptr && "Hasn't enough memory");
     if (affectedNode == nullptr)
+    {
+        m_statistics.failures++;
         return nullptr;
+    }
+
+    m_statistics.allocations++;
 
 
     // calculating the size we will take
-    wxASSERT_MSG((padding >= allocationHeaderSize), wxT("FreeListAllocator::Allocate: padding < allocationHeaderSize"));
+    assert((padding >= allocationHeaderSize) && "FreeListAllocator::Allocate: padding < allocationHeaderSize");
 
     const std::size_t alignmentPadding =  padding - allocationHeaderSize;
     const std::size_t requiredSize = size + padding;
 
     // calculating a rest of affected node's memory
-    wxASSERT_MSG((affectedNode->data.blockSize >= requiredSize), wxT("FreeListAllocator::Allocate: affectedNode->data.blockSize < requiredSize"));
+    assert((affectedNode->data.blockSize >= requiredSize) && "FreeListAllocator::Allocate: affectedNode->data.blockSize < requiredSize");
     const std::size_t rest = affectedNode->data.blockSize - requiredSize;
 
     // an issue with Free memory fixed here: [rest > sizeof(Node)] instead [rest > 0]
@@ -125,8 +130,12 @@ void FreeListAllocator::FindFirst(const std::size_t size, const std::size_t alig
     Node* _it = m_freeList.head;
     Node* _itPrev {nullptr};
 
+    std::size_t walk = 0;
+
     while (_it != nullptr)
     {
+        walk++;
+
         const std::size_t _padding = Utils::CalculatePaddingWithHeader(reinterpret_cast<std::size_t>(_it), alignment, sizeof(FreeListAllocator::AllocationHeader));
         const std::size_t _requiredSpace = size + _padding;
 
@@ -136,12 +145,16 @@ void FreeListAllocator::FindFirst(const std::size_t size, const std::size_t alig
             foundNode = _it;
             padding = _padding;
 
+            Statistics::CountWalk(m_statistics.allocateWalks, walk);
+
             return;
         }
 
         _itPrev = _it;
         _it = _it->next;
     }
+
+    Statistics::CountWalk(m_statistics.allocateWalks, walk);
 }
 
 // Iterate WHOLE list keeping a pointer to the best fit
@@ -152,8 +165,12 @@ void FreeListAllocator::FindBest(const std::size_t size, const std::size_t align
     Node* it = m_freeList.head;
     Node* itPrev {nullptr};
 
+    std::size_t walk = 0;
+
     while (it != nullptr)
     {
+        walk++;
+
         const std::size_t _padding = Utils::CalculatePaddingWithHeader(reinterpret_cast<std::size_t>(it), alignment, sizeof(FreeListAllocator::AllocationHeader));
         const std::size_t requiredSpace = size + _padding;
 
@@ -166,22 +183,24 @@ void FreeListAllocator::FindBest(const std::size_t size, const std::size_t align
             foundNode = it;
 
             if (smallestDiff == 0)
-                return;
+                break;
         }
 
         itPrev = it;
         it = it->next;
     }
+
+    Statistics::CountWalk(m_statistics.allocateWalks, walk);
 }
 
 void FreeListAllocator::Free(void* ptr)
 {
-    wxASSERT_MSG(m_start_ptr, wxT("FreeListAllocator::Free: allocator isn't initialized, m_start_ptr is NULL"));
-    wxASSERT_MSG(ptr, wxT("FreeListAllocator::Free: passed argument is NULL"));
+    assert(m_start_ptr && "FreeListAllocator::Free: allocator isn't initialized, m_start_ptr is NULL");
+    assert(ptr && "FreeListAllocator::Free: passed argument is NULL");
 
     const std::size_t currentAddress = reinterpret_cast<std::size_t>(ptr);
 
-    wxASSERT_MSG((currentAddress >= sizeof(FreeListAllocator::AllocationHeader)), wxT("FreeListAllocator::Free: currentAddress < sizeof(FreeListAllocator::AllocationHeader)"));
+    assert((currentAddress >= sizeof(FreeListAllocator::AllocationHeader)) && "FreeListAllocator::Free: currentAddress < sizeof(FreeListAllocator::AllocationHeader)");
     const std::size_t headerAddress = currentAddress - sizeof(FreeListAllocator::AllocationHeader);
 
     const FreeListAllocator::AllocationHeader* allocationHeader = reinterpret_cast<FreeListAllocator::AllocationHeader*>(headerAddress);
@@ -197,17 +216,23 @@ void FreeListAllocator::Free(void* ptr)
     Node* it = m_freeList.head;
     Node* itPrev = nullptr;
 
-    while (it != nullptr)
+    std::size_t walk = 0;
+
+    // the list is sorted by address, a block placed after the last free one goes to the tail
+    while (it != nullptr && it < freeNode)
     {
-        if (ptr < it) {
-            m_freeList.insert(itPrev, freeNode);
-            break;
-        }
         itPrev = it;
         it = it->next;
+
+        walk++;
     }
 
-    wxASSERT_MSG((m_used >= freeNode->data.blockSize), wxT("FreeListAllocator::Free: m_used < freeNode->data.blockSize"));
+    m_statistics.frees++;
+    Statistics::CountWalk(m_statistics.freeWalks, walk);
+
+    m_freeList.insert(itPrev, freeNode);
+
+    assert((m_used >= freeNode->data.blockSize) && "FreeListAllocator::Free: m_used < freeNode->data.blockSize");
     m_used -= freeNode->data.blockSize;
 
     // Merge contiguous nodes
@@ -229,13 +254,31 @@ void FreeListAllocator::Merge(Node* previousNode, Node* freeNode)
     }
 }
 
+Allocator::Statistics FreeListAllocator::GetStatistics()
+{
+    Statistics statistics = m_statistics;
+
+    for (Node* it = m_freeList.head; it != nullptr; it = it->next)
+    {
+        statistics.freeBlocks++;
+        statistics.freeSize += it->data.blockSize;
+
+        if (it->data.blockSize > statistics.largestFreeBlock)
+            statistics.largestFreeBlock = it->data.blockSize;
+    }
+
+    return statistics;
+}
+
 void FreeListAllocator::Reset()
 {
-    wxASSERT_MSG(m_start_ptr, wxT("FreeListAllocator::Reset: allocator isn't initialized, m_start_ptr is NULL"));
+    assert(m_start_ptr && "FreeListAllocator::Reset: allocator isn't initialized, m_start_ptr is NULL");
 
     m_used = 0;
     m_peak = 0;
 
+    m_statistics = Statistics();
+
     // create the first block that contains all of memory
 
     Node * firstNode = reinterpret_cast<Node*>(m_start_ptr);
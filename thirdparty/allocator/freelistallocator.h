@@ -57,6 +57,9 @@ public:
     virtual void Init() final;
 	virtual void Reset() final;
 
+    // free blocks are counted by a walk over the list
+    virtual Statistics GetStatistics() final;
+
 private:
     void Merge(Node* prevBlock, Node* freeBlock);
 
@@ -10,11 +10,8 @@
 #ifndef UTILS_H
 #define UTILS_H
 
-#include "wx/wxprec.h"
-
-#ifndef WX_PRECOMP
-#include <wx/wx.h>
-#endif
+#include <cstddef>
+#include <cassert>
 
 namespace mtrebi
 {
@@ -26,7 +23,7 @@ public:
         const std::size_t multiplier = (baseAddress / alignment) + 1;
         const std::size_t alignedAddress = multiplier * alignment;
 
-        wxASSERT_MSG((alignedAddress >= baseAddress), wxT("Utils::CalculatePadding: alignedAddress < baseAddress"));
+        assert((alignedAddress >= baseAddress) && "Utils::CalculatePadding: alignedAddress < baseAddress");
         const std::size_t padding = alignedAddress - baseAddress;
 
         return padding;
@@ -0,0 +1,228 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:               timingwheel.h
+// Description:        Hierarchical timing wheel for expiry of entities
+// Author:             Alexey Orlov (https://github.com/m110h)
+// Last modification:  18/08/2020
+// Licence:            MIT licence
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _TIMING_WHEEL_H_
+#define _TIMING_WHEEL_H_
+
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+namespace ProtoPuddle
+{
+
+// Time is counted in ticks (steps of the world). Every level has 256 slots,
+// a timer lies at the lowest level whose slots cover its delay. When the
+// lower level wraps, the current slot of the next level is redistributed
+// downwards, so every timer is touched at most once per level.
+//
+// Timers are kept in a pool and linked by indices. A timer carries a small
+// value (e.g. a handle of an entity). An owner of a timer keeps its index to
+// cancel it in O(1); the index is invalid after the timer fired or was
+// cancelled.
+template <class T>
+class TimingWheel
+{
+public:
+    TimingWheel()
+    {
+        Reset();
+    }
+
+    TimingWheel(const TimingWheel& src) = delete;
+    TimingWheel& operator=(const TimingWheel& r) = delete;
+
+    ~TimingWheel() {}
+
+    void Reset()
+    {
+        for (auto& level: slots)
+            level.fill(-1);
+
+        nodes.clear();
+        freeNode = -1;
+
+        now = 0;
+        quantity = 0;
+    }
+
+    std::uint64_t GetNow() const
+    {
+        return now;
+    }
+
+    // the timer fires after the given quantity of ticks (at least one)
+    int Schedule(const T& item, std::uint64_t delay)
+    {
+        if (delay == 0)
+            delay = 1;
+
+        int index = freeNode;
+
+        if (index >= 0)
+        {
+            freeNode = nodes[index].next;
+        }
+        else
+        {
+            index = static_cast<int>(nodes.size());
+            nodes.emplace_back();
+        }
+
+        nodes[index].item = item;
+        nodes[index].expiry = now + delay;
+
+        Insert(index);
+        quantity++;
+
+        return index;
+    }
+
+    void Cancel(int index)
+    {
+        Unlink(index);
+        Free(index);
+    }
+
+    std::uint64_t GetTimeLeft(int index) const
+    {
+        return nodes[index].expiry - now;
+    }
+
+    // moves time one tick forward and calls f(item) for every expired timer
+    template <class F>
+    void Advance(F f)
+    {
+        now++;
+
+        for (int level=1; level<levels; level++)
+        {
+            if (now & ((std::uint64_t(1) << (bits*level)) - 1))
+                break;
+
+            int& head = slots[level][(now >> (bits*level)) & slotMask];
+            int index = head;
+
+            head = -1;
+
+            while (index >= 0)
+            {
+                int next = nodes[index].next;
+                Insert(index);
+                index = next;
+            }
+        }
+
+        int& head = slots[0][now & slotMask];
+        int index = head;
+
+        head = -1;
+
+        while (index >= 0)
+        {
+            int next = nodes[index].next;
+            T item = nodes[index].item;
+
+            Free(index);
+            f(item);
+
+            index = next;
+        }
+    }
+
+    std::size_t GetQuantity() const
+    {
+        return quantity;
+    }
+
+    std::size_t GetMemoryUsage() const
+    {
+        return sizeof(slots) + nodes.capacity()*sizeof(Node);
+    }
+
+private:
+    static const int bits {8};
+    static const int levels {4};
+    static const std::uint64_t slotMask {(std::uint64_t(1) << bits) - 1};
+
+    struct Node
+    {
+        T item {};
+        std::uint64_t expiry {0};
+
+        int next {-1};
+        int prev {-1};
+        int level {0};
+    };
+
+    // delays beyond the last level are kept there and fire late by whole
+    // rotations, it doesn't matter for lifetimes of entities
+    void Insert(int index)
+    {
+        Node& node = nodes[index];
+
+        const std::uint64_t delay = node.expiry - now;
+
+        int level = 0;
+
+        while (level < levels-1 && delay >= (std::uint64_t(1) << (bits*(level+1))))
+            level++;
+
+        int& head = slots[level][(node.expiry >> (bits*level)) & slotMask];
+
+        node.level = level;
+        node.prev = -1;
+        node.next = head;
+
+        if (head >= 0)
+            nodes[head].prev = index;
+
+        head = index;
+    }
+
+    void Unlink(int index)
+    {
+        Node& node = nodes[index];
+
+        if (node.prev >= 0)
+        {
+            nodes[node.prev].next = node.next;
+        }
+        else
+        {
+            slots[node.level][(node.expiry >> (bits*node.level)) & slotMask] = node.next;
+        }
+
+        if (node.next >= 0)
+            nodes[node.next].prev = node.prev;
+    }
+
+    void Free(int index)
+    {
+        nodes[index].item = T();
+        nodes[index].next = freeNode;
+        nodes[index].prev = -1;
+
+        freeNode = index;
+        quantity--;
+    }
+
+private:
+    std::array<std::array<int, std::size_t(1) << bits>, levels> slots;
+
+    std::vector<Node> nodes;
+    int freeNode {-1};
+
+    std::uint64_t now {0};
+    std::size_t quantity {0};
+};
+
+}
+
+#endif
@@ -0,0 +1,64 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:               types.h
+// Description:        Basic value types of the simulation core (without wx)
+// Author:             Alexey Orlov (https://github.com/m110h)
+// Last modification:  18/08/2020
+// Licence:            MIT licence
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _TYPES_H_
+#define _TYPES_H_
+
+namespace ProtoPuddle
+{
+
+struct Point
+{
+    Point() {}
+    Point(int _x, int _y): x(_x), y(_y) {}
+
+    Point& operator+=(const Point& r) {
+        x += r.x;
+        y += r.y;
+        return *this;
+    }
+
+    int x {0};
+    int y {0};
+};
+
+inline Point operator+(const Point& l, const Point& r) { return Point(l.x+r.x, l.y+r.y); }
+inline bool operator==(const Point& l, const Point& r) { return (l.x == r.x) && (l.y == r.y); }
+inline bool operator!=(const Point& l, const Point& r) { return !(l == r); }
+
+struct Size
+{
+    Size() {}
+    Size(int _width, int _height): width(_width), height(_height) {}
+
+    int GetWidth() const { return width; }
+    int GetHeight() const { return height; }
+
+    void SetWidth(int _width) { width = _width; }
+    void SetHeight(int _height) { height = _height; }
+
+    int width {0};
+    int height {0};
+};
+
+struct Color
+{
+    Color() {}
+    Color(unsigned char _r, unsigned char _g, unsigned char _b): r(_r), g(_g), b(_b) {}
+
+    unsigned char r {0};
+    unsigned char g {0};
+    unsigned char b {0};
+};
+
+inline bool operator==(const Color& l, const Color& r) { return (l.r == r.r) && (l.g == r.g) && (l.b == r.b); }
+inline bool operator!=(const Color& l, const Color& r) { return !(l == r); }
+
+}
+
+#endif
@@ -0,0 +1,158 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:               workerpool.h
+// Description:        Pool of threads which share a list of tasks
+// Author:             Alexey Orlov (https://github.com/m110h)
+// Last modification:  18/08/2020
+// Licence:            MIT licence
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _WORKER_POOL_H_
+#define _WORKER_POOL_H_
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <cstddef>
+
+namespace ProtoPuddle
+{
+
+// The calling thread is worker 0 and takes tasks too, so a pool of one worker
+// has no threads and runs tasks in place. Tasks are taken one by one from a
+// shared counter, Run returns when all of them are done.
+class WorkerPool
+{
+public:
+    WorkerPool() {}
+
+    WorkerPool(const WorkerPool& src) = delete;
+    WorkerPool& operator=(const WorkerPool& r) = delete;
+
+    ~WorkerPool()
+    {
+        Stop();
+    }
+
+    void SetWorkers(int workers)
+    {
+        if (workers < 1)
+            workers = 1;
+
+        if (workers == GetWorkers())
+            return;
+
+        Stop();
+
+        for (int w=1; w<workers; w++)
+        {
+            threads.emplace_back([this, w, g = generation] { Work(w, g); });
+        }
+    }
+
+    int GetWorkers() const
+    {
+        return static_cast<int>(threads.size()) + 1;
+    }
+
+    // calls f(task, worker) for every task of [0, tasks)
+    void Run(std::size_t tasks, const std::function<void(std::size_t, int)>& f)
+    {
+        if (threads.empty() || tasks < 2)
+        {
+            for (std::size_t t=0; t<tasks; t++)
+                f(t, 0);
+
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            job = &f;
+            quantity = tasks;
+            next = 0;
+            busy = threads.size();
+            generation++;
+        }
+
+        wakeUp.notify_all();
+
+        Take(0);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return busy == 0; });
+
+        job = nullptr;
+    }
+
+private:
+    void Stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopped = true;
+        }
+
+        wakeUp.notify_all();
+
+        for (std::thread& thread: threads)
+            thread.join();
+
+        threads.clear();
+        stopped = false;
+    }
+
+    // a thread starts after the runs which were before it
+    void Work(int worker, std::size_t seen)
+    {
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wakeUp.wait(lock, [this, seen] { return stopped || generation != seen; });
+
+                if (stopped)
+                    return;
+
+                seen = generation;
+            }
+
+            Take(worker);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                busy--;
+            }
+
+            done.notify_one();
+        }
+    }
+
+    void Take(int worker)
+    {
+        for (std::size_t t = next++; t < quantity; t = next++)
+            (*job)(t, worker);
+    }
+
+private:
+    std::vector<std::thread> threads;
+
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::condition_variable done;
+
+    const std::function<void(std::size_t, int)>* job {nullptr};
+    std::size_t quantity {0};
+    std::atomic<std::size_t> next {0};
+
+    std::size_t busy {0};
+    std::size_t generation {0};
+    bool stopped {false};
+};
+
+}
+
+#endif